@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "allocation_counter.h"
+#include "rl_alloc_hooks.h"
+
+
+// Every global operator new and delete is replaced so nothing mixes with another allocator, they all end up in
+// allocate, allocate_aligned and their deallocate counterparts below.
+static std::atomic<std::uint64_t> allocation_calls = 0;
+static std::atomic<std::uint64_t> allocation_bytes = 0;
+static thread_local AllocTag current_tag = AllocTag::Untagged;
+
+static void count_allocation(std::size_t size) {
+    allocation_calls.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+const char* alloc_tag_name(AllocTag tag) {
+    switch (tag) {
+        case AllocTag::Untagged:
+            return "Untagged";
+        case AllocTag::Event:
+            return "Event";
+        case AllocTag::Update:
+            return "Update";
+        case AllocTag::Draw:
+            return "Draw";
+        case AllocTag::Assets:
+            return "Assets";
+    }
+
+    return "Unknown";
+}
+
+AllocScope::AllocScope(AllocTag tag) : previous{current_tag} {
+    current_tag = tag;
+}
+
+AllocScope::~AllocScope() {
+    current_tag = previous;
+}
+
+AllocationCounts allocation_counts() {
+    return AllocationCounts{allocation_calls.load(std::memory_order_relaxed), allocation_bytes.load(std::memory_order_relaxed)};
+}
+
+#ifdef CARD_GAME_ALLOC_TRACKING
+
+// Tracked blocks start with a header holding their size and tag, so a free can be attributed to whoever allocated.
+// Over-aligned blocks get a header as large as their alignment, the header always sits right before the memory.
+struct AllocationHeader {
+    std::size_t size;
+    AllocTag tag;
+};
+
+constexpr const std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+static_assert(sizeof(AllocationHeader) <= HEADER_SIZE);
+
+struct TagCounters {
+    std::atomic<std::uint64_t> calls = 0;
+    std::atomic<std::uint64_t> bytes = 0;
+    std::atomic<std::uint64_t> frees = 0;
+    std::atomic<std::int64_t> live_bytes = 0;
+};
+
+static std::array<TagCounters, ALLOC_TAG_COUNT> tag_counters;
+static std::atomic<std::size_t> live_bytes = 0;
+static std::atomic<std::size_t> peak_bytes = 0;
+
+static AllocationHeader& header_of(void* memory) {
+    return *reinterpret_cast<AllocationHeader*>(static_cast<std::byte*>(memory) - HEADER_SIZE);
+}
+
+// Writes the header in front of `memory` and counts the allocation.
+static void* track_allocation(void* block, std::size_t header_size, std::size_t size) {
+    if (!block) {
+        return nullptr;
+    }
+
+    void* memory = static_cast<std::byte*>(block) + header_size;
+    header_of(memory) = AllocationHeader{size, current_tag};
+    count_allocation(size);
+
+    TagCounters& counters = tag_counters[(std::size_t) current_tag];
+    counters.calls.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+    counters.live_bytes.fetch_add((std::int64_t) size, std::memory_order_relaxed);
+
+    std::size_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    std::size_t peak = peak_bytes.load(std::memory_order_relaxed);
+
+    while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+
+    return memory;
+}
+
+// Counts the free and returns the start of the block `memory` points into.
+static void* untrack_allocation(void* memory, std::size_t header_size) {
+    const AllocationHeader& header = header_of(memory);
+
+    TagCounters& counters = tag_counters[(std::size_t) header.tag];
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+    counters.live_bytes.fetch_sub((std::int64_t) header.size, std::memory_order_relaxed);
+    live_bytes.fetch_sub(header.size, std::memory_order_relaxed);
+
+    return static_cast<std::byte*>(memory) - header_size;
+}
+
+static std::size_t aligned_header_size(std::size_t alignment) {
+    return std::max(HEADER_SIZE, alignment);
+}
+
+static void* allocate(std::size_t size) {
+    return track_allocation(std::malloc(HEADER_SIZE + size), HEADER_SIZE, size);
+}
+
+static void* allocate_aligned(std::size_t size, std::size_t alignment) {
+    std::size_t header_size = aligned_header_size(alignment);
+    std::size_t rounded = (header_size + size + alignment - 1) / alignment * alignment;
+
+    return track_allocation(std::aligned_alloc(alignment, rounded), header_size, size);
+}
+
+static void deallocate(void* memory) {
+    if (memory) {
+        std::free(untrack_allocation(memory, HEADER_SIZE));
+    }
+}
+
+static void deallocate_aligned(void* memory, std::size_t alignment) {
+    if (memory) {
+        std::free(untrack_allocation(memory, aligned_header_size(alignment)));
+    }
+}
+
+bool allocation_tracking_enabled() {
+    return true;
+}
+
+AllocationTagCounts allocation_tag_counts(AllocTag tag) {
+    const TagCounters& counters = tag_counters[(std::size_t) tag];
+
+    return AllocationTagCounts{
+            counters.calls.load(std::memory_order_relaxed),
+            counters.bytes.load(std::memory_order_relaxed),
+            counters.frees.load(std::memory_order_relaxed),
+            counters.live_bytes.load(std::memory_order_relaxed)
+    };
+}
+
+std::size_t allocation_live_bytes() {
+    return live_bytes.load(std::memory_order_relaxed);
+}
+
+std::size_t allocation_peak_bytes() {
+    return peak_bytes.load(std::memory_order_relaxed);
+}
+
+extern "C" void* card_game_rl_malloc(size_t size) {
+    return allocate(size);
+}
+
+extern "C" void* card_game_rl_calloc(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return nullptr;
+    }
+
+    void* memory = allocate(count * size);
+
+    if (memory) {
+        std::memset(memory, 0, count * size);
+    }
+
+    return memory;
+}
+
+extern "C" void* card_game_rl_realloc(void* memory, size_t size) {
+    if (!memory) {
+        return allocate(size);
+    }
+
+    // Counted as a free and a new allocation, under the tag of whoever grows it. realloc carries the old header over.
+    void* block = std::realloc(static_cast<std::byte*>(memory) - HEADER_SIZE, HEADER_SIZE + size);
+
+    if (!block) {
+        return nullptr;
+    }
+
+    untrack_allocation(static_cast<std::byte*>(block) + HEADER_SIZE, HEADER_SIZE);
+
+    return track_allocation(block, HEADER_SIZE, size);
+}
+
+extern "C" void card_game_rl_free(void* memory) {
+    deallocate(memory);
+}
+
+#else
+
+static void* allocate(std::size_t size) {
+    count_allocation(size);
+
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+static void* allocate_aligned(std::size_t size, std::size_t alignment) {
+    count_allocation(size);
+
+    std::size_t rounded = size == 0 ? alignment : (size + alignment - 1) / alignment * alignment;
+
+    return std::aligned_alloc(alignment, rounded);
+}
+
+static void deallocate(void* memory) {
+    std::free(memory);
+}
+
+static void deallocate_aligned(void* memory, std::size_t) {
+    std::free(memory);
+}
+
+bool allocation_tracking_enabled() {
+    return false;
+}
+
+AllocationTagCounts allocation_tag_counts(AllocTag) {
+    return AllocationTagCounts{};
+}
+
+std::size_t allocation_live_bytes() {
+    return 0;
+}
+
+std::size_t allocation_peak_bytes() {
+    return 0;
+}
+
+#endif
+
+void* operator new(std::size_t size) {
+    if (void* memory = allocate(size)) {
+        return memory;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* memory = allocate_aligned(size, (std::size_t) alignment)) {
+        return memory;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+// std::stable_sort and friends take their scratch space through these, they must pair with the delete below.
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, (std::size_t) alignment);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, (std::size_t) alignment);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    deallocate(memory);
+}
+
+void operator delete(void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    deallocate_aligned(memory, (std::size_t) alignment);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    deallocate(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    deallocate_aligned(memory, (std::size_t) alignment);
+}
+
+void operator delete(void* memory) noexcept {
+    deallocate(memory);
+}
+
+void operator delete(void* memory, std::align_val_t alignment) noexcept {
+    deallocate_aligned(memory, (std::size_t) alignment);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    deallocate(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    deallocate_aligned(memory, (std::size_t) alignment);
+}
+
+void operator delete[](void* memory) noexcept {
+    deallocate(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+    deallocate_aligned(memory, (std::size_t) alignment);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    deallocate(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    deallocate_aligned(memory, (std::size_t) alignment);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Who allocates. Set per thread with ALLOC_SCOPE, anything outside of a scope is Untagged.
+enum class AllocTag : std::uint8_t {
+    Untagged,
+    Event,
+    Update,
+    Draw,
+    Assets,
+};
+
+constexpr const std::size_t ALLOC_TAG_COUNT = 5;
+
+const char* alloc_tag_name(AllocTag tag);
+
+struct AllocationCounts {
+    std::uint64_t calls = 0;
+    std::uint64_t bytes = 0;
+};
+
+struct AllocationTagCounts {
+    std::uint64_t calls = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t frees = 0;
+    std::int64_t live_bytes = 0; // Allocated under the tag and not freed yet, wherever the free happened.
+};
+
+// Totals of every global operator new since startup, on all threads. Diff two samples to get the allocations in between.
+AllocationCounts allocation_counts();
+
+// True when built with CARD_GAME_ALLOC_TRACKING. Only then are allocations attributed to tags, live and peak bytes
+// tracked and raylib's RL_MALLOC family routed through here. Otherwise the functions below read zero.
+bool allocation_tracking_enabled();
+
+AllocationTagCounts allocation_tag_counts(AllocTag tag);
+
+std::size_t allocation_live_bytes();
+
+std::size_t allocation_peak_bytes();
+
+// Attributes the calling thread's allocations to `tag` until destroyed.
+class AllocScope {
+public:
+    explicit AllocScope(AllocTag tag);
+
+    ~AllocScope();
+
+    AllocScope(const AllocScope&) = delete;
+
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocTag previous;
+};
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+
+#ifdef CARD_GAME_ALLOC_TRACKING
+#define ALLOC_SCOPE(tag) AllocScope ALLOC_CONCAT(alloc_scope_, __LINE__){tag}
+#else
+#define ALLOC_SCOPE(tag)
+#endif
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include "allocation_counter.h"
+#include "asset_loader.h"
+
+
+AssetLoader::AssetLoader(unsigned int worker_count) {
+    workers.reserve(std::max(worker_count, 1U));
+
+    for (unsigned int i = 0; i < std::max(worker_count, 1U); ++i) {
+        workers.emplace_back(&AssetLoader::work, this);
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    shutdown();
+}
+
+void AssetLoader::submit(DecodeTask task) {
+    ++pending;
+
+    {
+        std::lock_guard lock{decode_mutex};
+        decode_tasks.push_back(std::move(task));
+    }
+
+    decode_ready.notify_one();
+}
+
+void AssetLoader::upload(std::size_t max_uploads) {
+    for (std::size_t i = 0; i < max_uploads; ++i) {
+        UploadTask task;
+
+        {
+            std::lock_guard lock{upload_mutex};
+
+            if (upload_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(upload_tasks.front());
+            upload_tasks.pop_front();
+        }
+
+        task();
+        --pending;
+    }
+}
+
+void AssetLoader::shutdown() {
+    {
+        std::lock_guard lock{decode_mutex};
+        stopping = true;
+        decode_tasks.clear();
+    }
+
+    decode_ready.notify_all();
+
+    for (std::thread& worker: workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    workers.clear();
+
+    std::lock_guard lock{upload_mutex};
+    upload_tasks.clear();
+    pending = 0;
+}
+
+void AssetLoader::work() {
+    ALLOC_SCOPE(AllocTag::Assets);
+
+    while (true) {
+        DecodeTask task;
+
+        {
+            std::unique_lock lock{decode_mutex};
+            decode_ready.wait(lock, [this] {
+                return stopping || !decode_tasks.empty();
+            });
+
+            if (stopping) {
+                return;
+            }
+
+            task = std::move(decode_tasks.front());
+            decode_tasks.pop_front();
+        }
+
+        UploadTask upload_task = task();
+
+        if (!upload_task) {
+            --pending;
+
+            continue;
+        }
+
+        std::lock_guard lock{upload_mutex};
+        upload_tasks.push_back(std::move(upload_task));
+    }
+}
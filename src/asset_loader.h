@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Worker pool for asset decoding. A decode task runs on a worker and returns an upload task, which runs on the main
+// thread inside `upload` since that's the only thread allowed to touch GL. Decode tasks may submit more tasks and may
+// return an empty upload task when there's nothing to upload yet.
+class AssetLoader {
+public:
+    using UploadTask = std::function<void()>;
+    using DecodeTask = std::function<UploadTask()>;
+
+    explicit AssetLoader(unsigned int worker_count);
+
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    void submit(DecodeTask task);
+
+    // Runs at most `max_uploads` finished uploads. Call once per frame on the main thread.
+    void upload(std::size_t max_uploads);
+
+    // True when nothing is decoding or waiting for upload.
+    [[nodiscard]] bool is_idle() const {
+        return pending == 0;
+    }
+
+    // Joins the workers. Queued tasks and finished but not uploaded results are dropped.
+    void shutdown();
+
+private:
+    void work();
+
+    std::vector<std::thread> workers;
+    std::deque<DecodeTask> decode_tasks;
+    std::deque<UploadTask> upload_tasks;
+    std::mutex decode_mutex;
+    std::mutex upload_mutex;
+    std::condition_variable decode_ready;
+    std::atomic<std::size_t> pending = 0;
+    bool stopping = false;
+};
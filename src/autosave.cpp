@@ -0,0 +1,305 @@
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <utility>
+#include "autosave.h"
+
+
+// Autosave journal layout, native little endian:
+//   AutosaveHeader
+//   AutosaveRecord[] until the end of the file, a torn record at the end is ignored
+constexpr const char AUTOSAVE_MAGIC[4] = {'C', 'G', 'A', 'J'};
+constexpr const std::uint32_t AUTOSAVE_VERSION = 2;
+
+struct AutosaveHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t snapshot_hash; // Of the whole snapshot file the drops follow.
+};
+
+// A DropEvent, undos are logged as well so recovery can take the same drops back.
+struct AutosaveRecord {
+    std::uint64_t tick;
+    std::uint32_t action;
+    std::uint32_t entity;
+    std::uint32_t target;
+    std::uint32_t below;
+    std::uint32_t above;
+    float last_rec[4];
+    float offset[2];
+    std::uint32_t padding;
+};
+
+static_assert(sizeof(AutosaveHeader) == 16);
+static_assert(sizeof(AutosaveRecord) == 56);
+
+// FNV-1a.
+static std::uint64_t hash_bytes(std::span<const unsigned char> bytes) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (unsigned char byte: bytes) {
+        hash = (hash ^ byte) * 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+Autosave::~Autosave() {
+    stop();
+}
+
+bool Autosave::start(const Table& table, const char* snapshot_file_name_, const char* journal_file_name_,
+                     std::function<std::string_view(SpriteHandle)> sprite_name_) {
+    stop();
+
+    snapshot_file_name = snapshot_file_name_;
+    journal_file_name = journal_file_name_;
+    sprite_name = std::move(sprite_name_);
+    stopping = false;
+    pending_drops.clear();
+
+    if (!table.capture_snapshot(sprite_name, pending_sections)) {
+        return false;
+    }
+
+    is_compaction_pending = true;
+    pending_split = 0;
+    drops_since_compaction = 0;
+    writer = std::thread{&Autosave::write, this};
+
+    return true;
+}
+
+void Autosave::stop() {
+    if (!writer.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+    }
+
+    wake.notify_one();
+    writer.join();
+
+    if (journal) {
+        fclose(journal);
+        journal = nullptr;
+    }
+}
+
+void Autosave::record(const Table& table) {
+    const std::vector<DropEvent>& drops = table.get_drops();
+
+    if (drops.empty() || !writer.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock{mutex};
+        pending_drops.insert(pending_drops.end(), drops.begin(), drops.end());
+    }
+
+    drops_since_compaction += drops.size();
+
+    if (drops_since_compaction >= AUTOSAVE_COMPACT_DROPS) {
+        compact(table);
+    }
+}
+
+void Autosave::compact(const Table& table) {
+    if (!writer.joinable()) {
+        return;
+    }
+
+    {
+        // A compaction that is still waiting is simply replaced, its drops are part of this snapshot too. The writer
+        // only takes the lock to swap buffers, so capturing under it does not hold up the disk.
+        std::lock_guard lock{mutex};
+
+        if (!table.capture_snapshot(sprite_name, pending_sections)) {
+            return;
+        }
+
+        is_compaction_pending = true;
+        pending_split = pending_drops.size();
+    }
+
+    drops_since_compaction = 0;
+    wake.notify_one();
+}
+
+void Autosave::write() {
+    std::vector<AutosaveRecord> records;
+
+    auto append = [this, &records](std::size_t begin, std::size_t end) {
+        if (!journal || begin == end) {
+            return;
+        }
+
+        records.clear();
+
+        for (std::size_t i = begin; i < end; ++i) {
+            const DropEvent& drop = writing_drops[i];
+            AutosaveRecord& record = records.emplace_back();
+            record.tick = drop.tick;
+            record.action = (std::uint32_t) drop.action;
+            record.entity = drop.entity.raw();
+            record.target = drop.target.raw();
+            record.below = drop.below.raw();
+            record.above = drop.above.raw();
+            record.last_rec[0] = drop.last_rec.x;
+            record.last_rec[1] = drop.last_rec.y;
+            record.last_rec[2] = drop.last_rec.width;
+            record.last_rec[3] = drop.last_rec.height;
+            record.offset[0] = drop.offset.x;
+            record.offset[1] = drop.offset.y;
+        }
+
+        if (fwrite(records.data(), sizeof(AutosaveRecord), records.size(), journal) != records.size()) {
+            printf("Unable to append to %s.\n", journal_file_name.c_str());
+        }
+    };
+
+    auto sync = [this](bool appended) {
+        if (journal && appended && !sync_file(journal)) {
+            printf("Unable to sync %s.\n", journal_file_name.c_str());
+        }
+    };
+
+    std::unique_lock lock{mutex};
+
+    while (true) {
+        wake.wait_for(lock, AUTOSAVE_FLUSH_INTERVAL, [this] {
+            return stopping || is_compaction_pending;
+        });
+
+        // Group commit: everything recorded since the last pass goes out with one write and one sync.
+        bool stop_after = stopping;
+        bool compacting = is_compaction_pending;
+        writing_drops.swap(pending_drops);
+
+        if (compacting) {
+            std::swap(writing_sections, pending_sections);
+        }
+
+        std::size_t split = compacting ? pending_split : writing_drops.size();
+        is_compaction_pending = false;
+        pending_split = 0;
+        lock.unlock();
+
+        append(0, split);
+
+        if (compacting) {
+            // The drops the old snapshot is missing go down first, in case the new one never makes it.
+            sync(split > 0);
+            encode_snapshot_file(writing_sections, writing_snapshot);
+
+            if (write_snapshot_file(snapshot_file_name.c_str(), writing_snapshot)) {
+                open_journal(hash_bytes(writing_snapshot));
+            }
+        }
+
+        append(split, writing_drops.size());
+        sync(split < writing_drops.size() || (!compacting && split > 0));
+
+        writing_drops.clear();
+        lock.lock();
+
+        if (stop_after) {
+            return;
+        }
+    }
+}
+
+bool Autosave::open_journal(std::uint64_t snapshot_hash) {
+    if (journal) {
+        fclose(journal);
+    }
+
+    journal = fopen(journal_file_name.c_str(), "wb");
+
+    if (!journal) {
+        printf("Unable to open %s for writing.\n", journal_file_name.c_str());
+
+        return false;
+    }
+
+    AutosaveHeader header{};
+    std::memcpy(header.magic, AUTOSAVE_MAGIC, sizeof(header.magic));
+    header.version = AUTOSAVE_VERSION;
+    header.snapshot_hash = snapshot_hash;
+
+    if (fwrite(&header, sizeof(header), 1, journal) != 1 || !sync_file(journal)) {
+        printf("Unable to write %s.\n", journal_file_name.c_str());
+        fclose(journal);
+        journal = nullptr;
+
+        return false;
+    }
+
+    return true;
+}
+
+bool recover_autosave(Table& table, const char* snapshot_file_name, const char* journal_file_name,
+                      const std::function<SpriteHandle(std::string_view)>& sprite_for) {
+    std::error_code error;
+
+    if (!std::filesystem::exists(snapshot_file_name, error)) {
+        return false;
+    }
+
+    Snapshot snapshot;
+
+    if (!snapshot.open(snapshot_file_name) || !table.load_snapshot(snapshot, sprite_for)) {
+        return false;
+    }
+
+    std::vector<DropEvent> drops;
+
+    if (FILE* file = fopen(journal_file_name, "rb")) {
+        AutosaveHeader header{};
+
+        if (fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, AUTOSAVE_MAGIC, sizeof(header.magic)) == 0 &&
+            header.version == AUTOSAVE_VERSION && header.snapshot_hash == hash_bytes(snapshot.bytes())) {
+            AutosaveRecord record{};
+
+            while (fread(&record, sizeof(record), 1, file) == 1 && record.action <= (std::uint32_t) DropAction::Redo) {
+                drops.push_back(DropEvent{record.tick, (DropAction) record.action, EntityHandle::from_raw(record.entity),
+                                          EntityHandle::from_raw(record.target), EntityHandle::from_raw(record.below),
+                                          EntityHandle::from_raw(record.above),
+                                          Rectangle{record.last_rec[0], record.last_rec[1], record.last_rec[2], record.last_rec[3]},
+                                          Vector2{record.offset[0], record.offset[1]}});
+            }
+        }
+
+        fclose(file);
+    }
+
+    for (const DropEvent& drop: drops) {
+        if (drop.action == DropAction::Undo) {
+            table.revert_drop(drop);
+        } else {
+            table.apply_drop(drop);
+        }
+    }
+
+    Registry& registry = table.get_registry();
+    std::vector<EntityHandle> held;
+
+    for (EntityHandle entity: registry.view<TransformComponent, DraggableComponent>()) {
+        if (registry.get<DraggableComponent>(entity).is_selected) {
+            held.push_back(entity);
+        }
+    }
+
+    for (EntityHandle entity: held) {
+        table.apply_drop(DropEvent{table.get_tick(), DropAction::Drop, entity, NULL_ENTITY, NULL_ENTITY, NULL_ENTITY,
+                                   registry.get<TransformComponent>(entity).last_rec, Vector2{}});
+    }
+
+    printf("Recovered the autosave, %zu drops after its snapshot.\n", drops.size());
+
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "table.h"
+
+
+constexpr const std::chrono::milliseconds AUTOSAVE_FLUSH_INTERVAL{250};
+constexpr const std::size_t AUTOSAVE_COMPACT_DROPS = 256;
+
+// Write-ahead log of the table's drops, undos and redos included, on top of a base snapshot. The main thread only
+// copies drops into a pending batch, a writer thread appends every batch and syncs it to disk once per
+// AUTOSAVE_FLUSH_INTERVAL, so at most that much play is lost and a frame never waits on the disk. Every
+// AUTOSAVE_COMPACT_DROPS drops the table is captured for a fresh base snapshot, which the writer encodes, writes and
+// swaps in before starting the log over. Capturing copies the pools into buffers kept from the compaction before, a
+// few milliseconds at 100k cards, everything else is on the writer.
+//
+// The log's header carries a hash of the snapshot it continues, so a log left behind by a compaction that was cut off
+// half way is recognised and ignored, its drops are already part of the newer snapshot.
+class Autosave {
+public:
+    Autosave() = default;
+
+    ~Autosave();
+
+    Autosave(const Autosave&) = delete;
+
+    Autosave& operator=(const Autosave&) = delete;
+
+    // Starts the writer and a base snapshot of the table as it is now.
+    bool start(const Table& table, const char* snapshot_file_name, const char* journal_file_name,
+               std::function<std::string_view(SpriteHandle)> sprite_name_);
+
+    // Writes what is still pending and joins the writer.
+    void stop();
+
+    // Call right after stepping the table.
+    void record(const Table& table);
+
+    // Replaces the base snapshot with the table as it is now, for when it changed without dropping, like on a load.
+    void compact(const Table& table);
+
+private:
+    void write();
+
+    bool open_journal(std::uint64_t snapshot_hash);
+
+    std::string snapshot_file_name;
+    std::string journal_file_name;
+    std::function<std::string_view(SpriteHandle)> sprite_name;
+    std::size_t drops_since_compaction = 0;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::vector<DropEvent> pending_drops;
+    SnapshotData pending_sections; // Handed back and forth with `writing_sections`, so both keep their storage.
+    bool is_compaction_pending = false;
+    std::size_t pending_split = 0; // Pending drops before this belong to the log of the snapshot being replaced.
+
+    // Only the writer touches these while it runs.
+    FILE* journal = nullptr;
+    std::vector<DropEvent> writing_drops;
+    SnapshotData writing_sections;
+    std::vector<unsigned char> writing_snapshot;
+};
+
+// Loads the autosaved snapshot into `table` and replays the drops logged since. Cards still held when the autosave
+// was cut off go back to where they were picked up.
+bool recover_autosave(Table& table, const char* snapshot_file_name, const char* journal_file_name,
+                      const std::function<SpriteHandle(std::string_view)>& sprite_for);
@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <raylib.h>
+#include <rlgl.h>
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+
+#include <external/stb_rect_pack.h>
+#include "card_atlas.h"
+
+
+constexpr const int ATLAS_PADDING = 2;
+constexpr const int ATLAS_MAX_SIZE = 8192;
+constexpr const int WHITE_BLOCK_SIZE = 4;
+
+// Pack file layout, native little endian:
+//   CardPackHeader
+//   CardPackCell[cell_count]
+//   atlas pixels, width * height * 4 bytes of R8G8B8A8, ready for upload
+constexpr const char CARD_PACK_MAGIC[4] = {'C', 'P', 'A', 'K'};
+constexpr const std::uint32_t CARD_PACK_VERSION = 1;
+
+struct CardPackHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t cell_count;
+    float white_block[4];
+};
+
+struct CardPackCell {
+    char name[48];
+    float source[4];
+};
+
+static_assert(sizeof(CardPackHeader) == 36);
+static_assert(sizeof(CardPackCell) == 64);
+
+static bool pack_rects(std::vector<stbrp_rect>& rects, int width, int height) {
+    std::vector<stbrp_node> nodes((std::size_t) width);
+    stbrp_context context;
+
+    stbrp_init_target(&context, width, height, nodes.data(), (int) nodes.size());
+
+    return stbrp_pack_rects(&context, rects.data(), (int) rects.size()) == 1;
+}
+
+// Names and paths of the pngs in `directory`, sorted by name. Safe to call from any thread, unlike raylib's
+// GetFileNameWithoutExt which returns a static buffer.
+static std::vector<std::pair<std::string, std::string>> list_card_files(const std::string& directory) {
+    std::vector<std::pair<std::string, std::string>> files;
+    std::error_code error;
+
+    for (const std::filesystem::directory_entry& entry: std::filesystem::directory_iterator{directory, error}) {
+        if (entry.is_regular_file(error) && entry.path().extension() == ".png") {
+            files.emplace_back(entry.path().stem().string(), entry.path().string());
+        }
+    }
+
+    if (error) {
+        printf("Unable to list the cards in %s.\n", directory.c_str());
+    }
+
+    std::sort(files.begin(), files.end());
+
+    return files;
+}
+
+// Parses a file written by write_pack. The pixels keep pointing into `data`.
+static bool read_pack(unsigned char* data, unsigned int size, CardAtlasImage& result) {
+    CardPackHeader header{};
+
+    if (size >= sizeof(header)) {
+        std::memcpy(&header, data, sizeof(header));
+    }
+
+    std::size_t cells_bytes = (std::size_t) header.cell_count * sizeof(CardPackCell);
+    std::size_t pixel_bytes = (std::size_t) header.width * header.height * 4;
+
+    if (size < sizeof(header) || std::memcmp(header.magic, CARD_PACK_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != CARD_PACK_VERSION || size != sizeof(header) + cells_bytes + pixel_bytes) {
+        return false;
+    }
+
+    const unsigned char* cursor = data + sizeof(header);
+    result.cells.reserve(header.cell_count);
+
+    for (std::uint32_t i = 0; i < header.cell_count; ++i) {
+        CardPackCell cell{};
+        std::memcpy(&cell, cursor, sizeof(cell));
+        cursor += sizeof(cell);
+
+        cell.name[sizeof(cell.name) - 1] = '\0';
+        result.cells.emplace_back(cell.name, Rectangle{cell.source[0], cell.source[1], cell.source[2], cell.source[3]});
+    }
+
+    result.image = Image{(void*) cursor, (int) header.width, (int) header.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    result.white_block = Rectangle{header.white_block[0], header.white_block[1], header.white_block[2], header.white_block[3]};
+
+    return true;
+}
+
+Image CardAtlas::load_card_image(const char* file_name, int card_height) {
+    Image image = LoadImage(file_name);
+
+    if (image.data == nullptr) {
+        return image;
+    }
+
+    int card_width = (int) std::lround((float) image.width * (float) card_height / (float) image.height);
+    ImageResize(&image, card_width, card_height);
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    return image;
+}
+
+bool CardAtlas::pack(std::vector<std::pair<std::string, Image>>& images, CardAtlasImage& result) {
+    std::erase_if(images, [](const std::pair<std::string, Image>& named_image) {
+        return named_image.second.data == nullptr;
+    });
+
+    if (images.empty()) {
+        printf("Unable to build card atlas as there are no images.\n");
+
+        return false;
+    }
+
+    // The last rect is the white block used for shapes.
+    std::vector<stbrp_rect> rects(images.size() + 1);
+    long long area = 0;
+
+    for (std::size_t i = 0; i < rects.size(); ++i) {
+        int width = i < images.size() ? images[i].second.width : WHITE_BLOCK_SIZE;
+        int height = i < images.size() ? images[i].second.height : WHITE_BLOCK_SIZE;
+
+        rects[i].id = (int) i;
+        rects[i].w = width + ATLAS_PADDING;
+        rects[i].h = height + ATLAS_PADDING;
+        area += (long long) rects[i].w * rects[i].h;
+    }
+
+    int atlas_width = 256;
+    int atlas_height = 256;
+
+    while ((long long) atlas_width * atlas_height < area) {
+        (atlas_width <= atlas_height ? atlas_width : atlas_height) *= 2;
+    }
+
+    while (!pack_rects(rects, atlas_width, atlas_height)) {
+        if (atlas_width >= ATLAS_MAX_SIZE && atlas_height >= ATLAS_MAX_SIZE) {
+            printf("Unable to build card atlas as the cards don't fit in %dx%d.\n", ATLAS_MAX_SIZE, ATLAS_MAX_SIZE);
+
+            for (auto& [_, image]: images) {
+                UnloadImage(image);
+            }
+
+            images.clear();
+
+            return false;
+        }
+
+        (atlas_width <= atlas_height ? atlas_width : atlas_height) *= 2;
+    }
+
+    result.image = GenImageColor(atlas_width, atlas_height, BLANK);
+    result.cells.clear();
+    result.cells.reserve(images.size());
+
+    for (const stbrp_rect& rect: rects) {
+        if ((std::size_t) rect.id == images.size()) {
+            result.white_block = Rectangle{(float) rect.x, (float) rect.y, (float) WHITE_BLOCK_SIZE, (float) WHITE_BLOCK_SIZE};
+            ImageDrawRectangleRec(&result.image, result.white_block, WHITE);
+
+            continue;
+        }
+
+        const auto& [name, image] = images[(std::size_t) rect.id];
+        Rectangle source{(float) rect.x, (float) rect.y, (float) image.width, (float) image.height};
+
+        ImageDraw(&result.image, image, Rectangle{0.0F, 0.0F, (float) image.width, (float) image.height}, source, WHITE);
+        result.cells.emplace_back(name, source);
+    }
+
+    for (auto& [_, image]: images) {
+        UnloadImage(image);
+    }
+
+    images.clear();
+
+    return true;
+}
+
+bool CardAtlas::pack_directory(const char* directory, int card_height, CardAtlasImage& result) {
+    std::vector<std::pair<std::string, Image>> images;
+
+    for (const auto& [name, path]: list_card_files(directory)) {
+        images.emplace_back(name, load_card_image(path.c_str(), card_height));
+    }
+
+    return pack(images, result);
+}
+
+bool CardAtlas::write_pack(const CardAtlasImage& atlas_image, const char* file_name) {
+    const Image& image = atlas_image.image;
+
+    if (image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        printf("Unable to write card pack as the atlas is not RGBA8.\n");
+
+        return false;
+    }
+
+    std::size_t pixel_bytes = (std::size_t) GetPixelDataSize(image.width, image.height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    std::vector<unsigned char> data(sizeof(CardPackHeader) + atlas_image.cells.size() * sizeof(CardPackCell) + pixel_bytes);
+
+    CardPackHeader header{};
+    std::memcpy(header.magic, CARD_PACK_MAGIC, sizeof(header.magic));
+    header.version = CARD_PACK_VERSION;
+    header.width = (std::uint32_t) image.width;
+    header.height = (std::uint32_t) image.height;
+    header.cell_count = (std::uint32_t) atlas_image.cells.size();
+    header.white_block[0] = atlas_image.white_block.x;
+    header.white_block[1] = atlas_image.white_block.y;
+    header.white_block[2] = atlas_image.white_block.width;
+    header.white_block[3] = atlas_image.white_block.height;
+
+    unsigned char* cursor = data.data();
+    std::memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+
+    for (const auto& [name, source]: atlas_image.cells) {
+        CardPackCell cell{};
+
+        if (name.size() >= sizeof(cell.name)) {
+            printf("Unable to write card pack as %s is too long of a card name.\n", name.c_str());
+
+            return false;
+        }
+
+        std::memcpy(cell.name, name.data(), name.size());
+        cell.source[0] = source.x;
+        cell.source[1] = source.y;
+        cell.source[2] = source.width;
+        cell.source[3] = source.height;
+
+        std::memcpy(cursor, &cell, sizeof(cell));
+        cursor += sizeof(cell);
+    }
+
+    std::memcpy(cursor, image.data, pixel_bytes);
+
+    return SaveFileData(file_name, data.data(), (unsigned int) data.size());
+}
+
+void CardAtlas::load_async(AssetLoader& asset_loader, TextureCache& texture_cache, SpriteTable& sprite_table,
+                           std::string pack_file, std::string directory, int card_height) {
+    // Either path ends in this upload, which runs on the main thread.
+    auto upload = [this, &texture_cache, &sprite_table](std::shared_ptr<CardAtlasImage> atlas_image, unsigned char* file_data) -> AssetLoader::UploadTask {
+        return [this, &texture_cache, &sprite_table, atlas_image, file_data]() {
+            adopt(texture_cache, sprite_table, *atlas_image);
+
+            if (file_data) {
+                UnloadFileData(file_data);
+            } else {
+                UnloadImage(atlas_image->image);
+            }
+        };
+    };
+
+    // Every png is decoded on its own worker and the last one to finish packs the atlas.
+    auto decode_directory = [&asset_loader, upload, directory, card_height]() {
+        struct PendingImages {
+            std::mutex mutex;
+            std::vector<std::pair<std::string, Image>> images;
+            std::size_t remaining;
+        };
+
+        std::vector<std::pair<std::string, std::string>> files = list_card_files(directory);
+        auto pending = std::make_shared<PendingImages>();
+        pending->remaining = files.size();
+
+        for (auto& [name, path]: files) {
+            asset_loader.submit([upload, pending, card_height, name = std::move(name), path = std::move(path)]() -> AssetLoader::UploadTask {
+                Image image = load_card_image(path.c_str(), card_height);
+
+                {
+                    std::lock_guard lock{pending->mutex};
+                    pending->images.emplace_back(name, image);
+
+                    if (--pending->remaining > 0) {
+                        return {};
+                    }
+                }
+
+                auto atlas_image = std::make_shared<CardAtlasImage>();
+
+                if (!pack(pending->images, *atlas_image)) {
+                    return {};
+                }
+
+                return upload(atlas_image, nullptr);
+            });
+        }
+    };
+
+    if (!std::filesystem::exists(pack_file)) {
+        decode_directory();
+
+        return;
+    }
+
+    // A pack that can't be read is no worse than a missing one, the pngs are decoded instead.
+    asset_loader.submit([upload, decode_directory, pack_file]() -> AssetLoader::UploadTask {
+        unsigned int size = 0;
+        unsigned char* data = LoadFileData(pack_file.c_str(), &size);
+        auto atlas_image = std::make_shared<CardAtlasImage>();
+
+        if (data == nullptr || !read_pack(data, size, *atlas_image)) {
+            printf("Unable to load card pack %s as it is corrupt or from another version, decoding the cards instead.\n", pack_file.c_str());
+            UnloadFileData(data);
+            decode_directory();
+
+            return {};
+        }
+
+        return upload(atlas_image, data);
+    });
+}
+
+void CardAtlas::adopt(TextureCache& texture_cache, SpriteTable& sprite_table, CardAtlasImage& atlas_image) {
+    release(texture_cache);
+
+    atlas_texture = texture_cache.insert(LoadTextureFromImage(atlas_image.image));
+
+    for (const auto& [name, source]: atlas_image.cells) {
+        sprite_table.assign(texture_cache, name, atlas_texture, source);
+    }
+
+    // Shapes sample the center of the white block so filtering never reaches the padding.
+    const Rectangle& white_block = atlas_image.white_block;
+    SetShapesTexture(texture_cache.get(atlas_texture), Rectangle{white_block.x + 1.0F, white_block.y + 1.0F, white_block.width - 2.0F, white_block.height - 2.0F});
+}
+
+void CardAtlas::release(TextureCache& texture_cache) {
+    if (atlas_texture == NULL_TEXTURE) {
+        return;
+    }
+
+    // Back to raylib's own white pixel, whatever id the GL driver gave it.
+    SetShapesTexture(Texture2D{rlGetTextureIdDefault(), 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8}, Rectangle{0.0F, 0.0F, 1.0F, 1.0F});
+    texture_cache.release(atlas_texture);
+    atlas_texture = NULL_TEXTURE;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <raylib.h>
+#include "asset_loader.h"
+#include "sprite_table.h"
+#include "texture_cache.h"
+
+
+constexpr const int CARD_ATLAS_HEIGHT = 240; // Card faces are packed at twice their drawn size so they stay sharp on HiDPI.
+
+// CPU side result of packing, shared by the runtime build and the offline card_game_pack tool.
+struct CardAtlasImage {
+    Image image{};
+    Rectangle white_block{};
+    std::vector<std::pair<std::string, Rectangle>> cells;
+};
+
+// Every card face packed into one texture, so the whole table goes through rlgl in a single batch instead of
+// flushing on each texture switch. A white texel block is packed alongside and used as the shapes texture,
+// which keeps the debug slot outlines in the same batch too.
+class CardAtlas {
+public:
+    // Decodes one card face and scales it to `card_height` pixels tall. Safe to call from any thread.
+    static Image load_card_image(const char* file_name, int card_height);
+
+    // Packs the named images with stb_rect_pack. Unloads the images.
+    static bool pack(std::vector<std::pair<std::string, Image>>& images, CardAtlasImage& result);
+
+    // Loads and packs every png in `directory` on the calling thread.
+    static bool pack_directory(const char* directory, int card_height, CardAtlasImage& result);
+
+    // Writes the packed atlas as raw RGBA plus its cell index, see card_atlas.cpp for the layout.
+    static bool write_pack(const CardAtlasImage& atlas_image, const char* file_name);
+
+    // Reads `pack_file` on a loader worker, or when it is missing or can't be read decodes the pngs in `directory`
+    // across all workers and packs them. The atlas is uploaded and each cell assigned to the sprite of the same name from
+    // AssetLoader::upload, so calling this again with another directory swaps the skin of every card.
+    void load_async(AssetLoader& asset_loader, TextureCache& texture_cache, SpriteTable& sprite_table,
+                    std::string pack_file, std::string directory, int card_height);
+
+    void release(TextureCache& texture_cache);
+
+    [[nodiscard]] TextureHandle texture() const {
+        return atlas_texture;
+    }
+
+private:
+    void adopt(TextureCache& texture_cache, SpriteTable& sprite_table, CardAtlasImage& atlas_image);
+
+    TextureHandle atlas_texture = NULL_TEXTURE;
+};
@@ -0,0 +1,284 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "frame_arena.h"
+#include "render_list.h"
+#include "stack.h"
+#include "table.h"
+
+
+// Benchmarks the table's hot paths at several table sizes and stack depths and writes the results as JSON.
+// Usage: card_game_bench [output json]   (stdout when no file is given)
+
+constexpr const double MIN_BENCH_SECONDS = 0.1;
+constexpr const std::size_t LOOKUP_BATCH = 1024;
+constexpr const float STACK_OFFSET_Y = -16.0F;
+constexpr const float STACK_SPACING = 4.0F;
+
+constexpr const std::size_t BENCH_CARDS[] = {9, 1000, 100000};
+constexpr const std::uint32_t BENCH_STACK_DEPTHS[] = {1, 10, 100, 500};
+constexpr const char* SNAPSHOT_BENCH_FILE = "card_game_bench.cgs";
+
+// Keeps the optimizer from dropping the measured work.
+static volatile float sink;
+
+struct BenchResult {
+    std::string name;
+    std::size_t cards;
+    std::uint32_t stack_depth;
+    std::uint64_t ops;
+    double seconds;
+};
+
+// Cards laid out as `cards / stack_depth` slots in a square grid, each with `stack_depth` cards stacked on it.
+struct Fixture {
+    Fixture(std::size_t cards_, std::uint32_t stack_depth_) : cards{cards_}, stack_depth{stack_depth_}, stacks{std::max<std::size_t>(cards_ / stack_depth_, 1)},
+                                                             columns{(std::size_t) std::ceil(std::sqrt((double) stacks))},
+                                                             table{bounds(columns, stack_depth_)} {
+        build();
+    }
+
+    static Rectangle bounds(std::size_t columns, std::uint32_t stack_depth) {
+        return Rectangle{0.0F, 0.0F, (float) columns * (CARD_WIDTH + STACK_SPACING), (float) columns * row_height(stack_depth)};
+    }
+
+    static float row_height(std::uint32_t stack_depth) {
+        return CARD_HEIGHT + STACK_SPACING - STACK_OFFSET_Y * (float) stack_depth;
+    }
+
+    [[nodiscard]] Vector2 slot_position(std::size_t stack) const {
+        float row_bottom = (float) (stack / columns + 1) * row_height(stack_depth);
+
+        return Vector2{(float) (stack % columns) * (CARD_WIDTH + STACK_SPACING), row_bottom - CARD_HEIGHT - STACK_SPACING};
+    }
+
+    void build() {
+        slots.clear();
+        table.clear();
+
+        for (std::size_t stack = 0; stack < stacks; ++stack) {
+            EntityHandle slot = table.create_slot(slot_position(stack), 0.0F, STACK_OFFSET_Y);
+            slots.push_back(slot);
+
+            for (std::uint32_t depth = 0; depth < stack_depth; ++depth) {
+                table.stack_to_entity(table.create_card(Vector2{}, (SpriteHandle) depth, true), top(stack));
+            }
+        }
+    }
+
+    [[nodiscard]] EntityHandle top(std::size_t stack) {
+        StackComponent* stack_component = table.get_registry().try_get<StackComponent>(slots[stack]);
+
+        return stack_component ? stack_component->members.back() : slots[stack];
+    }
+
+    std::size_t cards;
+    std::uint32_t stack_depth;
+    std::size_t stacks;
+    std::size_t columns;
+    Table table;
+    std::vector<EntityHandle> slots;
+};
+
+// Runs `batch` until MIN_BENCH_SECONDS have passed. `batch` returns how many operations it did.
+static BenchResult measure(std::string name, const Fixture& fixture, const std::function<std::uint64_t()>& batch) {
+    BenchResult result{std::move(name), fixture.cards, fixture.stack_depth, 0, 0.0};
+    auto start = std::chrono::steady_clock::now();
+
+    do {
+        result.ops += batch();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (result.seconds < MIN_BENCH_SECONDS);
+
+    fprintf(stderr, "%-20s cards=%-7zu depth=%-4u %12.1f ns/op\n", result.name.c_str(), result.cards, result.stack_depth, result.seconds * 1e9 / (double) result.ops);
+
+    return result;
+}
+
+static void run_benchmarks(Fixture& fixture, std::vector<BenchResult>& results) {
+    Registry& registry = fixture.table.get_registry();
+    FrameArena& frame_arena = FrameArena::instance();
+    std::mt19937 rng{0};
+
+    std::vector<EntityHandle> cards;
+
+    for (EntityHandle entity: registry.view<TransformComponent, DraggableComponent>()) {
+        cards.push_back(entity);
+    }
+
+    std::uniform_int_distribution<std::size_t> random_card{0, cards.size() - 1};
+    std::uniform_int_distribution<std::size_t> random_stack{0, fixture.stacks - 1};
+
+    results.push_back(measure("get_screen_rec", fixture, [&]() -> std::uint64_t {
+        float sum = 0.0F;
+
+        for (std::size_t i = 0; i < LOOKUP_BATCH; ++i) {
+            sum += fixture.table.get_screen_rec(cards[random_card(rng)]).y;
+        }
+
+        sink = sum;
+
+        return LOOKUP_BATCH;
+    }));
+
+    results.push_back(measure("stack_index", fixture, [&]() -> std::uint64_t {
+        std::uint32_t sum = 0;
+
+        for (std::size_t i = 0; i < LOOKUP_BATCH; ++i) {
+            EntityHandle card = cards[random_card(rng)];
+            sum += registry.get<TransformComponent>(card).stack_index + (is_stack_top(registry, card) ? 1 : 0);
+        }
+
+        sink = (float) sum;
+
+        return LOOKUP_BATCH;
+    }));
+
+    results.push_back(measure("top_entity", fixture, [&]() -> std::uint64_t {
+        std::uint32_t found = 0;
+
+        for (std::size_t i = 0; i < LOOKUP_BATCH; ++i) {
+            Rectangle rec = fixture.table.get_screen_rec(fixture.top(random_stack(rng)));
+            found += fixture.table.pick(Vector2{rec.x + rec.width * 0.5F, rec.y + rec.height * 0.5F}) != NULL_ENTITY;
+            frame_arena.reset();
+        }
+
+        sink = (float) found;
+
+        return LOOKUP_BATCH;
+    }));
+
+    results.push_back(measure("closest_entity", fixture, [&]() -> std::uint64_t {
+        std::uint32_t found = 0;
+
+        for (std::size_t i = 0; i < LOOKUP_BATCH; ++i) {
+            found += fixture.table.drop_target(cards[random_card(rng)]) != NULL_ENTITY;
+            frame_arena.reset();
+        }
+
+        sink = (float) found;
+
+        return LOOKUP_BATCH;
+    }));
+
+    // Every stack hands its top card to the next one, so the depths are the same after each batch.
+    results.push_back(measure("stack_to_entity", fixture, [&]() -> std::uint64_t {
+        for (std::size_t stack = 0; stack < fixture.stacks; ++stack) {
+            fixture.table.stack_to_entity(fixture.top(stack), fixture.top((stack + 1) % fixture.stacks));
+            frame_arena.reset();
+        }
+
+        return fixture.stacks;
+    }));
+
+    // Building the draw order from nothing, as a fresh table or a loaded save would.
+    results.push_back(measure("render_list_build", fixture, [&]() -> std::uint64_t {
+        RenderList render_list;
+
+        for (EntityHandle entity: registry.view<TransformComponent, RenderComponent>()) {
+            render_list.update(entity, RenderList::Key{RenderLayer::Table, registry.get<TransformComponent>(entity).stack_index});
+        }
+
+        sink = (float) render_list.entries().size();
+
+        return registry.storage<RenderComponent>().size();
+    }));
+
+    // What the draw loop does every frame before issuing draw calls.
+    results.push_back(measure("render_list_walk", fixture, [&]() -> std::uint64_t {
+        float sum = 0.0F;
+
+        for (const RenderList::Entry& entry: fixture.table.get_render_list().entries()) {
+            sum += fixture.table.get_screen_rec(entry.entity).x;
+        }
+
+        sink = sum;
+
+        return fixture.table.get_render_list().entries().size();
+    }));
+
+    // Suspend and resume of the whole table, per entity.
+    std::vector<std::string> sprite_names;
+
+    for (std::uint32_t depth = 0; depth < fixture.stack_depth; ++depth) {
+        sprite_names.push_back("sprite_" + std::to_string(depth));
+    }
+
+    results.push_back(measure("snapshot_write", fixture, [&]() -> std::uint64_t {
+        fixture.table.write_snapshot(SNAPSHOT_BENCH_FILE, [&sprite_names](SpriteHandle sprite) -> std::string_view {
+            return sprite_names[sprite];
+        });
+
+        return registry.size();
+    }));
+
+    Snapshot snapshot;
+    snapshot.open(SNAPSHOT_BENCH_FILE);
+
+    results.push_back(measure("snapshot_load", fixture, [&]() -> std::uint64_t {
+        SpriteHandle next_sprite = 0;
+        fixture.table.load_snapshot(snapshot, [&next_sprite](std::string_view) {
+            return next_sprite++;
+        });
+
+        return registry.size();
+    }));
+
+    snapshot.close();
+    std::remove(SNAPSHOT_BENCH_FILE);
+
+    // Slots and cards created and stacked, including the table clear between rounds.
+    results.push_back(measure("create_entities", fixture, [&]() -> std::uint64_t {
+        fixture.build();
+
+        return fixture.stacks * (fixture.stack_depth + 1);
+    }));
+}
+
+static void write_json(FILE* file, const std::vector<BenchResult>& results) {
+    fprintf(file, "{\n  \"version\": 1,\n  \"benchmarks\": [\n");
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& result = results[i];
+        fprintf(file, R"(    {"name": "%s", "cards": %zu, "stack_depth": %u, "ops": %llu, "seconds": %.6f, "ns_per_op": %.3f}%s)" "\n",
+                result.name.c_str(), result.cards, result.stack_depth, (unsigned long long) result.ops, result.seconds,
+                result.seconds * 1e9 / (double) result.ops, i + 1 < results.size() ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    std::vector<BenchResult> results;
+
+    for (std::size_t cards: BENCH_CARDS) {
+        for (std::uint32_t stack_depth: BENCH_STACK_DEPTHS) {
+            if (stack_depth > cards) {
+                continue;
+            }
+
+            Fixture fixture{cards, stack_depth};
+            run_benchmarks(fixture, results);
+        }
+    }
+
+    FILE* file = argc > 1 ? fopen(argv[1], "w") : stdout;
+
+    if (!file) {
+        printf("Unable to open %s for writing.\n", argv[1]);
+
+        return 1;
+    }
+
+    write_json(file, results);
+
+    if (file != stdout) {
+        fclose(file);
+    }
+
+    return 0;
+}
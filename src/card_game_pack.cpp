@@ -0,0 +1,30 @@
+#include <cstdio>
+#include <cstdlib>
+#include <raylib.h>
+#include "card_atlas.h"
+
+
+// Offline asset packer: decodes and packs the card faces once so the game only has to upload the result.
+// Usage: card_game_pack <card directory> <output pack> [card height]
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printf("Usage: %s <card directory> <output pack> [card height]\n", argv[0]);
+
+        return 1;
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    int card_height = argc > 3 ? atoi(argv[3]) : CARD_ATLAS_HEIGHT;
+    CardAtlasImage atlas_image;
+
+    if (!CardAtlas::pack_directory(argv[1], card_height, atlas_image)) {
+        return 1;
+    }
+
+    bool written = CardAtlas::write_pack(atlas_image, argv[2]);
+    printf("Packed %zu cards into a %dx%d atlas: %s\n", atlas_image.cells.size(), atlas_image.image.width, atlas_image.image.height, argv[2]);
+    UnloadImage(atlas_image.image);
+
+    return written ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <memory_resource>
+#include <unordered_map>
+#include <unordered_set>
+#include "command_buffer.h"
+#include "frame_arena.h"
+#include "table.h"
+
+
+void CommandBuffer::create_card(Vector2 position, SpriteHandle sprite, bool is_stackable) {
+    commands.push_back(Command{Type::CreateCard, NULL_ENTITY, NULL_ENTITY, position, Vector2{}, sprite, is_stackable});
+}
+
+void CommandBuffer::create_slot(Vector2 position, float offset_x, float offset_y) {
+    commands.push_back(Command{Type::CreateSlot, NULL_ENTITY, NULL_ENTITY, position, Vector2{offset_x, offset_y}});
+}
+
+void CommandBuffer::destroy(EntityHandle entity) {
+    commands.push_back(Command{Type::Destroy, entity});
+}
+
+void CommandBuffer::attach_to_stack(EntityHandle entity, EntityHandle target) {
+    commands.push_back(Command{Type::AttachToStack, entity, target});
+}
+
+void CommandBuffer::detach(EntityHandle entity) {
+    commands.push_back(Command{Type::Detach, entity});
+}
+
+void CommandBuffer::move(EntityHandle entity, Vector2 position) {
+    commands.push_back(Command{Type::Move, entity, NULL_ENTITY, position});
+}
+
+void CommandBuffer::apply(Table& table) {
+    if (commands.empty()) {
+        return;
+    }
+
+    // Coalesce, walking backwards so every command already knows what happens to its entities later on.
+    FrameArena& frame_arena = FrameArena::instance();
+    std::pmr::unordered_set<EntityHandle> destroyed{&frame_arena};
+    std::pmr::unordered_map<EntityHandle, bool> moved_later{&frame_arena};
+    dropped.assign(commands.size(), false);
+
+    for (std::size_t i = commands.size(); i-- > 0;) {
+        const Command& command = commands[i];
+
+        if (command.type == Type::Destroy) {
+            dropped[i] = !destroyed.insert(command.entity).second;
+            moved_later[command.entity] = false;
+
+            continue;
+        }
+
+        if (command.entity != NULL_ENTITY && destroyed.contains(command.entity)) {
+            dropped[i] = true;
+
+            continue;
+        }
+
+        if (command.type == Type::Move) {
+            bool& later = moved_later[command.entity];
+            dropped[i] = later;
+            later = true;
+
+            continue;
+        }
+
+        if (command.entity != NULL_ENTITY) {
+            moved_later[command.entity] = false;
+        }
+
+        if (command.target != NULL_ENTITY) {
+            moved_later[command.target] = false;
+        }
+    }
+
+    Registry& registry = table.get_registry();
+
+    for (std::size_t i = 0; i < commands.size(); ++i) {
+        const Command& command = commands[i];
+
+        if (dropped[i] || (command.entity != NULL_ENTITY && !registry.is_valid(command.entity))) {
+            continue;
+        }
+
+        switch (command.type) {
+            case Type::CreateCard:
+                table.create_card(command.position, command.sprite, command.is_stackable);
+                break;
+            case Type::CreateSlot:
+                table.create_slot(command.position, command.offset.x, command.offset.y);
+                break;
+            case Type::Destroy:
+                table.destroy(command.entity);
+                break;
+            case Type::AttachToStack:
+                if (registry.is_valid(command.target)) {
+                    table.stack_to_entity(command.entity, command.target);
+                }
+                break;
+            case Type::Detach:
+                table.detach(command.entity);
+                break;
+            case Type::Move:
+                table.move(command.entity, command.position);
+                break;
+        }
+    }
+
+    commands.clear();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <raylib.h>
+#include "entity.h"
+#include "sprite_handle.h"
+
+
+class Table;
+
+// Structural changes recorded by systems while they iterate, applied together at a sync point. Systems only read
+// component storage and the links between entities while running, so they can iterate it in any order and, with a
+// buffer each, in parallel. Not thread safe, give every concurrently running system its own buffer.
+class CommandBuffer {
+public:
+    void create_card(Vector2 position, SpriteHandle sprite, bool is_stackable);
+
+    void create_slot(Vector2 position, float offset_x, float offset_y);
+
+    void destroy(EntityHandle entity);
+
+    void attach_to_stack(EntityHandle entity, EntityHandle target);
+
+    void detach(EntityHandle entity);
+
+    void move(EntityHandle entity, Vector2 position);
+
+    [[nodiscard]] bool empty() const {
+        return commands.empty();
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return commands.size();
+    }
+
+    // Applies everything recorded in order and clears the buffer. Before that, commands are coalesced: a run of moves of
+    // the same entity with nothing else touching it in between keeps only the last move, and everything recorded for an
+    // entity that is destroyed later in the batch is dropped. Commands on entities that are gone by then are skipped.
+    void apply(Table& table);
+
+    void clear() {
+        commands.clear();
+    }
+
+private:
+    enum class Type : std::uint8_t {
+        CreateCard,
+        CreateSlot,
+        Destroy,
+        AttachToStack,
+        Detach,
+        Move,
+    };
+
+    struct Command {
+        Type type;
+        EntityHandle entity = NULL_ENTITY;
+        EntityHandle target = NULL_ENTITY;
+        Vector2 position{};
+        Vector2 offset{};
+        SpriteHandle sprite = NULL_SPRITE;
+        bool is_stackable = false;
+    };
+
+    std::vector<Command> commands;
+    std::vector<bool> dropped;
+};
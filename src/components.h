@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <raylib.h>
+#include "entity.h"
+#include "sprite_handle.h"
+
+
+struct TransformComponent {
+    explicit TransformComponent(Rectangle rec_) : rec{rec_}, last_rec{rec_}, screen_rec{rec_}, previous_screen_rec{rec_}, screen_rec_tick{0},
+                                                  stack_root{NULL_ENTITY}, stack_index{0} {
+
+    }
+
+    Rectangle rec;
+    Rectangle last_rec;
+    Rectangle screen_rec; // Cached result of rec plus the stack offsets. Refreshed when the stack is re-linked or the entity moves.
+    Rectangle previous_screen_rec; // screen_rec as of the tick before `screen_rec_tick`, drawing interpolates from it.
+    std::uint64_t screen_rec_tick; // Last tick screen_rec changed in.
+    EntityHandle stack_root; // Entity owning the StackComponent this entity is a member of. NULL_ENTITY when not stacked.
+    std::uint32_t stack_index; // Position inside the stack, 0 being the root.
+
+    // TODO: Use GLM Vector
+};
+
+struct RenderComponent {
+    explicit RenderComponent(SpriteHandle sprite_, float offset_x_, float offset_y_, bool face_up_ = true) : sprite{sprite_}, offset_x{offset_x_},
+                                                                                                        offset_y{offset_y_}, face_up{face_up_} {
+
+    }
+
+    SpriteHandle sprite; // NULL_SPRITE draws the debug outline instead.
+    float offset_x;
+    float offset_y;
+    bool face_up; // Face down cards keep their face in `sprite`, the front end draws the card back over it.
+};
+
+struct DraggableComponent {
+    bool is_selected = false;
+};
+
+struct StackableComponent {
+    // TODO: Add stack limit here.
+};
+
+// Lives on the bottom entity of a stack (usually a slot). Members are ordered bottom to top and members[0] is the root itself.
+// Every member mirrors its position in TransformComponent::stack_index, so depth and top checks are O(1).
+struct StackComponent {
+    std::vector<EntityHandle> members;
+};
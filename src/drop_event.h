@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <raylib.h>
+#include "entity.h"
+
+
+enum class DropAction : std::uint8_t {
+    Drop, // The Drop System ended a drag.
+    Undo, // An earlier drop was taken back.
+    Redo, // An undone drop was done again.
+};
+
+// A drag that ended, as a reversible delta: enough of where the entity came from to put it back, and what it went onto.
+struct DropEvent {
+    std::uint64_t tick;
+    DropAction action;
+    EntityHandle entity;
+    EntityHandle target; // Stacked onto, NULL_ENTITY when the entity went back to `last_rec`.
+    EntityHandle below; // Member the entity sat on, NULL_ENTITY when it was at the bottom of its stack or on its own.
+    EntityHandle above; // Member above it when it was at the bottom, it became the bottom once the entity left.
+    Rectangle last_rec; // Where it was picked up.
+    Vector2 offset; // Its stack offsets before the drop took the target's.
+};
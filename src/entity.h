@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <uuid.h>
+
+
+// Persistent identity, only used for serialization and networking. Runtime code references entities via EntityHandle.
+using EntityId = uuids::uuid;
+using EntityIndex = std::uint32_t;
+
+// 32-bit runtime reference: low bits index the registry slot, high bits hold the slot's generation so a handle
+// to a destroyed entity is rejected by a single compare instead of silently aliasing the slot's next owner.
+class EntityHandle {
+public:
+    static constexpr std::uint32_t INDEX_BITS = 20;
+    static constexpr std::uint32_t GENERATION_BITS = 32 - INDEX_BITS;
+    static constexpr std::uint32_t INDEX_MASK = (1U << INDEX_BITS) - 1U;
+    static constexpr std::uint32_t MAX_GENERATION = (1U << GENERATION_BITS) - 1U;
+
+    constexpr EntityHandle() = default;
+
+    constexpr EntityHandle(EntityIndex index_, std::uint32_t generation_) : value{(generation_ << INDEX_BITS) | (index_ & INDEX_MASK)} {
+
+    }
+
+    [[nodiscard]] constexpr EntityIndex index() const {
+        return value & INDEX_MASK;
+    }
+
+    [[nodiscard]] constexpr std::uint32_t generation() const {
+        return value >> INDEX_BITS;
+    }
+
+    [[nodiscard]] constexpr std::uint32_t raw() const {
+        return value;
+    }
+
+    static constexpr EntityHandle from_raw(std::uint32_t raw_) {
+        EntityHandle handle;
+        handle.value = raw_;
+
+        return handle;
+    }
+
+    constexpr bool operator==(const EntityHandle&) const = default;
+
+private:
+    std::uint32_t value = std::numeric_limits<std::uint32_t>::max();
+};
+
+constexpr const EntityHandle NULL_ENTITY{};
+
+template<>
+struct std::hash<EntityHandle> {
+    std::size_t operator()(EntityHandle handle) const noexcept {
+        return std::hash<std::uint32_t>{}(handle.raw());
+    }
+};
@@ -0,0 +1,24 @@
+#include "fixed_timestep.h"
+
+
+FixedTimestep::FixedTimestep(double ticks_per_second, std::uint32_t max_ticks_per_frame_) : tick_seconds{1.0 / ticks_per_second},
+                                                                                           max_ticks_per_frame{max_ticks_per_frame_} {
+
+}
+
+std::uint32_t FixedTimestep::advance(double frame_seconds) {
+    accumulator += frame_seconds;
+
+    std::uint32_t ticks = 0;
+
+    while (accumulator >= tick_seconds && ticks < max_ticks_per_frame) {
+        accumulator -= tick_seconds;
+        ++ticks;
+    }
+
+    if (ticks == max_ticks_per_frame && accumulator >= tick_seconds) {
+        accumulator = 0.0;
+    }
+
+    return ticks;
+}
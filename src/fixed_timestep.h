@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+
+constexpr const double SIMULATION_TICKS_PER_SECOND = 120.0;
+constexpr const std::uint32_t MAX_TICKS_PER_FRAME = 8;
+
+// Turns variable frame times into a whole number of fixed length ticks, so how fast frames come doesn't change what
+// the simulation does. The time left over is how far presentation is into the next tick.
+class FixedTimestep {
+public:
+    FixedTimestep(double ticks_per_second, std::uint32_t max_ticks_per_frame_);
+
+    // Adds the frame's time and returns how many ticks to run for it. A backlog beyond `max_ticks_per_frame` is
+    // dropped, the simulation slows down instead of falling further behind after a stall.
+    std::uint32_t advance(double frame_seconds);
+
+    // 0 to 1, where between the last two ticks to draw.
+    [[nodiscard]] float alpha() const {
+        return (float) (accumulator / tick_seconds);
+    }
+
+    [[nodiscard]] double get_tick_seconds() const {
+        return tick_seconds;
+    }
+
+private:
+    double tick_seconds;
+    double accumulator = 0.0;
+    std::uint32_t max_ticks_per_frame;
+};
@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <cstdint>
+#include "frame_arena.h"
+
+
+FrameArena& FrameArena::instance() {
+    static thread_local FrameArena frame_arena{FRAME_ARENA_CAPACITY};
+
+    return frame_arena;
+}
+
+FrameArena::FrameArena(std::size_t capacity_) : buffer{std::make_unique<std::byte[]>(capacity_)}, buffer_size{capacity_} {
+
+}
+
+void FrameArena::reset() {
+    peak_used = std::max(peak_used, offset);
+    offset = 0;
+    overflowed = 0;
+    overflow.release();
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    auto base = reinterpret_cast<std::uintptr_t>(buffer.get());
+    std::uintptr_t aligned = (base + offset + alignment - 1) & ~(std::uintptr_t) (alignment - 1);
+
+    if (aligned + bytes <= base + buffer_size) {
+        offset = aligned + bytes - base;
+
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    overflowed += bytes;
+
+    return overflow.allocate(bytes, alignment);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+
+constexpr const std::size_t FRAME_ARENA_CAPACITY = 256 * 1024;
+
+// Linear allocator for data that never outlives the frame. Allocating bumps an offset, deallocating does nothing and
+// reset() takes everything back at once. A frame that outgrows the buffer spills into the heap until the next reset,
+// which shows up as `overflow_bytes`; size the capacity so that stays zero. Not thread safe.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    // The calling thread's arena. The main thread resets its own once per frame, job workers after each job.
+    static FrameArena& instance();
+
+    explicit FrameArena(std::size_t capacity_);
+
+    FrameArena(const FrameArena&) = delete;
+
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Call once per frame, after everything allocated from the arena is gone.
+    void reset();
+
+    [[nodiscard]] std::size_t used() const {
+        return offset;
+    }
+
+    // Highest `used` seen at a reset.
+    [[nodiscard]] std::size_t peak() const {
+        return peak_used;
+    }
+
+    [[nodiscard]] std::size_t capacity() const {
+        return buffer_size;
+    }
+
+    [[nodiscard]] std::size_t overflow_bytes() const {
+        return overflowed;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::unique_ptr<std::byte[]> buffer;
+    std::size_t buffer_size;
+    std::size_t offset = 0;
+    std::size_t peak_used = 0;
+    std::size_t overflowed = 0;
+    std::pmr::monotonic_buffer_resource overflow;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cmath>
+#include <raylib.h>
+#include "raymath.h"
+
+
+// Only raylib's plain structs and the header-only raymath are used here, so the simulation can be built
+// and run without linking raylib. The collision tests mirror CheckCollisionPointRec/CheckCollisionRecs.
+
+inline Vector2 RecToVec(Rectangle rec) {
+    return Vector2{rec.x - rec.width * 0.5F, rec.y - rec.height * 0.5F};
+}
+
+inline float RecDistSqr(Rectangle rec1, Rectangle rec2) {
+    return Vector2DistanceSqr(RecToVec(rec1), RecToVec(rec2));
+}
+
+inline bool close_to(float a, float b, float epsilon) {
+    return std::fabs(a - b) <= ((std::fabs(a) < std::fabs(b) ? std::fabs(b) : std::fabs(a)) * epsilon);
+}
+
+inline bool rec_equals(Rectangle rec1, Rectangle rec2) {
+    float ep = 0.01F;
+
+    return close_to(rec1.x, rec2.x, ep) &&
+           close_to(rec1.y, rec2.y, ep) &&
+           close_to(rec1.width, rec2.width, ep) &&
+           close_to(rec1.height, rec2.height, ep);
+}
+
+inline bool point_in_rec(Vector2 point, Rectangle rec) {
+    return point.x >= rec.x && point.x < rec.x + rec.width && point.y >= rec.y && point.y < rec.y + rec.height;
+}
+
+inline bool recs_overlap(Rectangle rec1, Rectangle rec2) {
+    return rec1.x < rec2.x + rec2.width && rec1.x + rec1.width > rec2.x &&
+           rec1.y < rec2.y + rec2.height && rec1.y + rec1.height > rec2.y;
+}
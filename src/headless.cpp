@@ -0,0 +1,97 @@
+#include <chrono>
+#include <random>
+#include <vector>
+#include "allocation_counter.h"
+#include "frame_arena.h"
+#include "headless.h"
+#include "job_system.h"
+
+
+constexpr const std::uint32_t BOT_DRAG_TICKS = 8;
+
+static Vector2 rec_center(Rectangle rec) {
+    return Vector2{rec.x + rec.width * 0.5F, rec.y + rec.height * 0.5F};
+}
+
+static EntityHandle random_entity(const std::vector<EntityHandle>& entities, std::mt19937& rng) {
+    if (entities.empty()) {
+        return NULL_ENTITY;
+    }
+
+    return entities[std::uniform_int_distribution<std::size_t>{0, entities.size() - 1}(rng)];
+}
+
+HeadlessStats run_headless(Table& table, std::uint64_t ticks, std::uint32_t seed) {
+    std::mt19937 rng{seed};
+    Registry& registry = table.get_registry();
+    HeadlessStats stats;
+
+    Vector2 from{};
+    Vector2 to{};
+    std::uint32_t drag_tick = 0;
+
+    FrameArena& frame_arena = FrameArena::instance();
+    std::uint64_t allocations_at_start = allocation_counts().calls;
+    auto start = std::chrono::steady_clock::now();
+
+    for (; stats.ticks < ticks; ++stats.ticks) {
+        InputFrame input;
+
+        if (registry.storage<DraggableComponent>().size() == 0 || registry.storage<StackableComponent>().size() == 0) {
+            table.step(input);
+            frame_arena.reset();
+
+            continue;
+        }
+
+        if (drag_tick == 0) {
+            from = rec_center(table.get_screen_rec(random_entity(registry.storage<DraggableComponent>().entities(), rng)));
+            to = rec_center(table.get_screen_rec(random_entity(registry.storage<StackableComponent>().entities(), rng)));
+            input.pointer = from;
+            input.pressed = true;
+        } else {
+            float t = (float) drag_tick / (float) BOT_DRAG_TICKS;
+            input.pointer = Vector2{from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t};
+        }
+
+        if (++drag_tick > BOT_DRAG_TICKS) {
+            input.released = true;
+            drag_tick = 0;
+            ++stats.drops;
+        }
+
+        table.step(input);
+        frame_arena.reset();
+    }
+
+    stats.allocations = allocation_counts().calls - allocations_at_start;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return stats;
+}
+
+HeadlessStats run_headless(std::span<Table* const> tables, std::uint64_t ticks, std::uint32_t seed) {
+    std::vector<HeadlessStats> table_stats(tables.size());
+    std::uint64_t allocations_at_start = allocation_counts().calls;
+    auto start = std::chrono::steady_clock::now();
+
+    // Tables share nothing, so each one is a job of its own.
+    JobSystem::instance().parallel_for(tables.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            table_stats[i] = run_headless(*tables[i], ticks, seed + (std::uint32_t) i);
+        }
+    });
+
+    HeadlessStats stats;
+
+    for (const HeadlessStats& table_stat: table_stats) {
+        stats.ticks += table_stat.ticks;
+        stats.drops += table_stat.drops;
+    }
+
+    // Counted once for the whole run, the per table counts overlap when the tables run at the same time.
+    stats.allocations = allocation_counts().calls - allocations_at_start;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return stats;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "table.h"
+
+
+struct HeadlessStats {
+    std::uint64_t ticks = 0;
+    std::uint64_t drops = 0;
+    std::uint64_t allocations = 0; // Heap allocations during the run, zero once every container has grown to size.
+    double seconds = 0.0;
+};
+
+// Steps the table as fast as possible with a seeded bot that keeps picking up a random card
+// and dropping it on a random stackable entity.
+HeadlessStats run_headless(Table& table, std::uint64_t ticks, std::uint32_t seed);
+
+// One bot per table, the tables spread over the job system's workers. Table i is seeded `seed + i`. Ticks and drops
+// are summed over the tables, allocations and `seconds` cover the whole run.
+HeadlessStats run_headless(std::span<Table* const> tables, std::uint64_t ticks, std::uint32_t seed);
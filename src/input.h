@@ -0,0 +1,14 @@
+#pragma once
+
+#include <raylib.h>
+
+
+// Everything the simulation reads from the outside world in one step. The raylib front end fills it from
+// the mouse, headless runs and replays synthesize it.
+struct InputFrame {
+    Vector2 pointer{};
+    bool pressed = false; // Primary button went down since the last step.
+    bool released = false; // Primary button went up since the last step.
+    bool undo = false; // Take the last drop back.
+    bool redo = false; // Make the last undone drop again.
+};
@@ -0,0 +1,276 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include "frame_arena.h"
+#include "input_journal.h"
+
+
+// Journal file layout, native little endian:
+//   JournalHeader
+//   std::uint64_t checkpoints[checkpoint_count]
+//   unsigned char base_snapshot[base_snapshot_size]  a snapshot file, padded to 8 bytes
+//   input runs until tick_count ticks are covered, each:
+//     std::uint8_t flags (JOURNAL_*)
+//     float pointer x, y when JOURNAL_POINTER is set, otherwise the pointer of the run before
+//     varint run length, ticks with this same input
+constexpr const char JOURNAL_MAGIC[4] = {'C', 'G', 'I', 'J'};
+constexpr const std::uint32_t JOURNAL_VERSION = 2;
+
+constexpr const std::uint8_t JOURNAL_PRESSED = 1U << 0U;
+constexpr const std::uint8_t JOURNAL_RELEASED = 1U << 1U;
+constexpr const std::uint8_t JOURNAL_POINTER = 1U << 2U;
+constexpr const std::uint8_t JOURNAL_UNDO = 1U << 3U;
+constexpr const std::uint8_t JOURNAL_REDO = 1U << 4U;
+
+struct JournalHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t seed;
+    std::uint32_t checkpoint_ticks;
+    std::uint64_t tick_count;
+    std::uint64_t checkpoint_count;
+    std::uint64_t base_snapshot_size;
+};
+
+static_assert(sizeof(JournalHeader) == 40);
+
+static std::size_t padded_size(std::uint64_t size) {
+    return (std::size_t) ((size + 7) / 8 * 8);
+}
+
+static bool same_input(const InputFrame& a, const InputFrame& b) {
+    return a.pointer.x == b.pointer.x && a.pointer.y == b.pointer.y && a.pressed == b.pressed && a.released == b.released &&
+           a.undo == b.undo && a.redo == b.redo;
+}
+
+void InputJournal::begin(std::uint32_t seed_) {
+    seed = seed_;
+    tick_count = 0;
+    runs.clear();
+    runs.reserve(JOURNAL_RESERVED_RUNS);
+    checkpoints.clear();
+    checkpoints.reserve(JOURNAL_RESERVED_CHECKPOINTS);
+    base_snapshot.clear();
+}
+
+bool InputJournal::begin(const Table& table, const std::function<std::string_view(SpriteHandle)>& sprite_name) {
+    begin(table.get_seed());
+
+    if (!table.encode_snapshot(sprite_name, base_snapshot)) {
+        printf("Unable to keep the table in the input journal, it only replays onto a generated table.\n");
+        base_snapshot.clear();
+
+        return false;
+    }
+
+    return true;
+}
+
+void InputJournal::record(const InputFrame& input, const Table& table) {
+    if (!runs.empty() && runs.back().ticks < UINT32_MAX && same_input(runs.back().input, input)) {
+        ++runs.back().ticks;
+    } else {
+        runs.push_back(InputRun{input, 1});
+    }
+
+    ++tick_count;
+
+    if (tick_count % checkpoint_ticks == 0) {
+        checkpoints.push_back(table.state_hash());
+    }
+}
+
+static void write_varint(std::vector<unsigned char>& data, std::uint64_t value) {
+    while (value >= 0x80) {
+        data.push_back((unsigned char) (value | 0x80));
+        value >>= 7;
+    }
+
+    data.push_back((unsigned char) value);
+}
+
+static bool read_varint(const unsigned char*& cursor, const unsigned char* end, std::uint64_t& value) {
+    value = 0;
+
+    for (unsigned int shift = 0; cursor < end && shift < 64; shift += 7) {
+        unsigned char byte = *cursor++;
+        value |= (std::uint64_t) (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool write_input_journal(const InputJournal& journal, const char* file_name) {
+    std::size_t base_offset = sizeof(JournalHeader) + journal.checkpoints.size() * sizeof(std::uint64_t);
+    std::vector<unsigned char> data(base_offset + padded_size(journal.base_snapshot.size()));
+
+    JournalHeader header{};
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.seed = journal.seed;
+    header.checkpoint_ticks = journal.checkpoint_ticks;
+    header.tick_count = journal.tick_count;
+    header.checkpoint_count = journal.checkpoints.size();
+    header.base_snapshot_size = journal.base_snapshot.size();
+
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), journal.checkpoints.data(), journal.checkpoints.size() * sizeof(std::uint64_t));
+
+    if (!journal.base_snapshot.empty()) {
+        std::memcpy(data.data() + base_offset, journal.base_snapshot.data(), journal.base_snapshot.size());
+    }
+
+    Vector2 pointer{};
+
+    for (const InputRun& run: journal.runs) {
+        const InputFrame& input = run.input;
+        bool pointer_moved = input.pointer.x != pointer.x || input.pointer.y != pointer.y;
+        data.push_back((input.pressed ? JOURNAL_PRESSED : 0) | (input.released ? JOURNAL_RELEASED : 0) | (pointer_moved ? JOURNAL_POINTER : 0) |
+                       (input.undo ? JOURNAL_UNDO : 0) | (input.redo ? JOURNAL_REDO : 0));
+
+        if (pointer_moved) {
+            data.resize(data.size() + sizeof(float) * 2);
+            std::memcpy(data.data() + data.size() - sizeof(float) * 2, &input.pointer.x, sizeof(float));
+            std::memcpy(data.data() + data.size() - sizeof(float), &input.pointer.y, sizeof(float));
+            pointer = input.pointer;
+        }
+
+        write_varint(data, run.ticks);
+    }
+
+    FILE* file = fopen(file_name, "wb");
+
+    if (!file) {
+        printf("Unable to open %s for writing.\n", file_name);
+
+        return false;
+    }
+
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+
+    if (!written) {
+        printf("Unable to write the input journal to %s.\n", file_name);
+    }
+
+    return written;
+}
+
+bool read_input_journal(const char* file_name, InputJournal& journal) {
+    FILE* file = fopen(file_name, "rb");
+
+    if (!file) {
+        printf("Unable to open %s for reading.\n", file_name);
+
+        return false;
+    }
+
+    std::vector<unsigned char> data;
+    unsigned char buffer[4096];
+
+    for (std::size_t read; (read = fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+
+    fclose(file);
+
+    JournalHeader header{};
+
+    if (data.size() >= sizeof(header)) {
+        std::memcpy(&header, data.data(), sizeof(header));
+    }
+
+    if (data.size() < sizeof(header) || std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != JOURNAL_VERSION || header.checkpoint_ticks == 0 ||
+        header.checkpoint_count > (data.size() - sizeof(header)) / sizeof(std::uint64_t) ||
+        header.base_snapshot_size > data.size() - sizeof(header) - header.checkpoint_count * sizeof(std::uint64_t) ||
+        padded_size(header.base_snapshot_size) > data.size() - sizeof(header) - header.checkpoint_count * sizeof(std::uint64_t)) {
+        printf("Unable to read %s as it is not an input journal.\n", file_name);
+
+        return false;
+    }
+
+    journal.begin(header.seed);
+    journal.checkpoint_ticks = header.checkpoint_ticks;
+    journal.checkpoints.resize(header.checkpoint_count);
+    std::memcpy(journal.checkpoints.data(), data.data() + sizeof(header), header.checkpoint_count * sizeof(std::uint64_t));
+
+    const unsigned char* cursor = data.data() + sizeof(header) + header.checkpoint_count * sizeof(std::uint64_t);
+    journal.base_snapshot.assign(cursor, cursor + header.base_snapshot_size);
+    cursor += padded_size(header.base_snapshot_size);
+    const unsigned char* end = data.data() + data.size();
+    Vector2 pointer{};
+
+    while (journal.tick_count < header.tick_count) {
+        if (cursor >= end) {
+            printf("Unable to read %s as it ends early.\n", file_name);
+
+            return false;
+        }
+
+        std::uint8_t flags = *cursor++;
+
+        if (flags & JOURNAL_POINTER) {
+            if (end - cursor < (std::ptrdiff_t) (sizeof(float) * 2)) {
+                printf("Unable to read %s as it ends early.\n", file_name);
+
+                return false;
+            }
+
+            std::memcpy(&pointer.x, cursor, sizeof(float));
+            std::memcpy(&pointer.y, cursor + sizeof(float), sizeof(float));
+            cursor += sizeof(float) * 2;
+        }
+
+        std::uint64_t run = 0;
+
+        if (!read_varint(cursor, end, run) || run == 0 || run > UINT32_MAX || run > header.tick_count - journal.tick_count) {
+            printf("Unable to read %s as a run of input is broken.\n", file_name);
+
+            return false;
+        }
+
+        journal.runs.push_back(InputRun{InputFrame{pointer, (flags & JOURNAL_PRESSED) != 0, (flags & JOURNAL_RELEASED) != 0,
+                                                   (flags & JOURNAL_UNDO) != 0, (flags & JOURNAL_REDO) != 0},
+                                        (std::uint32_t) run});
+        journal.tick_count += run;
+    }
+
+    return true;
+}
+
+ReplayStats replay_input_journal(Table& table, const InputJournal& journal) {
+    ReplayStats stats;
+    FrameArena& frame_arena = FrameArena::instance();
+    auto start = std::chrono::steady_clock::now();
+
+    for (const InputRun& run: journal.runs) {
+        for (std::uint32_t i = 0; i < run.ticks && stats.diverged_tick == 0; ++i) {
+            table.step(run.input);
+            frame_arena.reset();
+            ++stats.ticks;
+
+            if (stats.ticks % journal.checkpoint_ticks != 0 || stats.checkpoints >= journal.checkpoints.size()) {
+                continue;
+            }
+
+            if (table.state_hash() != journal.checkpoints[stats.checkpoints]) {
+                stats.diverged_tick = stats.ticks;
+            } else {
+                ++stats.checkpoints;
+            }
+        }
+
+        if (stats.diverged_tick != 0) {
+            break;
+        }
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return stats;
+}
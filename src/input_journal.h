@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+#include "input.h"
+#include "table.h"
+
+
+constexpr const std::uint32_t JOURNAL_CHECKPOINT_TICKS = 120;
+constexpr const std::size_t JOURNAL_RESERVED_RUNS = 1U << 16U; // About 1 MiB, hours of ordinary play.
+constexpr const std::size_t JOURNAL_RESERVED_CHECKPOINTS = 1U << 12U;
+
+// Ticks in a row that got the same input.
+struct InputRun {
+    InputFrame input;
+    std::uint32_t ticks;
+};
+
+// Everything needed to play a session again: the table's seed and the input of every tick, plus state hashes to
+// check a replay against. A recording that began from a loaded or recovered table carries that table as a snapshot,
+// otherwise replaying assumes the table is generated from the seed the way it was when recording began.
+//
+// Input is run length encoded as it is recorded, a tick with the same input as the one before only counts up the
+// last run. Runs and checkpoints are reserved up front, so recording only allocates once a session outgrows them.
+struct InputJournal {
+    std::uint32_t seed = 0;
+    std::uint32_t checkpoint_ticks = JOURNAL_CHECKPOINT_TICKS;
+    std::uint64_t tick_count = 0;
+    std::vector<InputRun> runs;
+    std::vector<std::uint64_t> checkpoints; // Table::state_hash() after every `checkpoint_ticks` ticks.
+    std::vector<unsigned char> base_snapshot; // Encoded table the recording began from, empty for a generated one.
+
+    // Starts a new recording of a table seeded with `seed_`.
+    void begin(std::uint32_t seed_);
+
+    // Starts a new recording of `table` as it is now, which a replay loads instead of generating one.
+    bool begin(const Table& table, const std::function<std::string_view(SpriteHandle)>& sprite_name);
+
+    // Call right after stepping the table with `input`.
+    void record(const InputFrame& input, const Table& table);
+};
+
+// Compact binary, runs of ticks with the same input are stored once. The base snapshot is stored as it is.
+bool write_input_journal(const InputJournal& journal, const char* file_name);
+
+bool read_input_journal(const char* file_name, InputJournal& journal);
+
+struct ReplayStats {
+    std::uint64_t ticks = 0;
+    std::uint64_t checkpoints = 0; // Checkpoints whose hash matched.
+    std::uint64_t diverged_tick = 0; // Tick of the first checkpoint that did not match, 0 if every one did.
+    double seconds = 0.0;
+};
+
+// Steps the table through the journal as fast as possible, stopping at the first checkpoint that does not match.
+ReplayStats replay_input_journal(Table& table, const InputJournal& journal);
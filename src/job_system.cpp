@@ -0,0 +1,170 @@
+#include "frame_arena.h"
+#include "job_system.h"
+
+
+constexpr const std::size_t JOB_QUEUE_INITIAL_CAPACITY = 64;
+
+// Which queue the calling thread pushes to and pops from first, 0 unless it is one of `worker_owner`'s workers.
+static thread_local const JobSystem* worker_owner = nullptr;
+static thread_local std::size_t worker_queue = 0;
+
+JobSystem& JobSystem::instance() {
+    static JobSystem job_system;
+
+    return job_system;
+}
+
+JobSystem::~JobSystem() {
+    shutdown();
+}
+
+void JobSystem::start(unsigned int worker_count) {
+    shutdown();
+
+    stopping = false;
+    queues.clear();
+
+    for (unsigned int i = 0; i <= worker_count; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+        queues.back()->jobs.resize(JOB_QUEUE_INITIAL_CAPACITY);
+    }
+
+    workers.reserve(worker_count);
+
+    for (unsigned int i = 0; i < worker_count; ++i) {
+        workers.emplace_back(&JobSystem::work, this, i + 1);
+    }
+}
+
+void JobSystem::shutdown() {
+    {
+        std::lock_guard lock{sleep_mutex};
+        stopping = true;
+    }
+
+    work_ready.notify_all();
+
+    for (std::thread& worker: workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    workers.clear();
+}
+
+void JobSystem::submit(JobCounter& counter, Job job) {
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (workers.empty()) {
+        run(QueuedJob{job, &counter});
+
+        return;
+    }
+
+    Queue& queue = *queues[worker_owner == this ? worker_queue : 0];
+
+    {
+        std::lock_guard lock{queue.mutex};
+
+        if (queue.size == queue.jobs.size()) {
+            // Unwrap into a buffer twice the size.
+            std::vector<QueuedJob> grown(queue.jobs.size() * 2);
+
+            for (std::size_t i = 0; i < queue.size; ++i) {
+                grown[i] = queue.jobs[(queue.head + i) % queue.jobs.size()];
+            }
+
+            queue.jobs = std::move(grown);
+            queue.head = 0;
+        }
+
+        queue.jobs[(queue.head + queue.size) % queue.jobs.size()] = QueuedJob{job, &counter};
+        ++queue.size;
+    }
+
+    queued.fetch_add(1);
+
+    // Taking the lock orders the increment before a worker that is about to sleep checks it.
+    {
+        std::lock_guard lock{sleep_mutex};
+    }
+
+    work_ready.notify_one();
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    std::size_t index = worker_owner == this ? worker_queue : 0;
+
+    while (counter.pending.load(std::memory_order_acquire) > 0) {
+        QueuedJob job{};
+
+        if (take(index, job)) {
+            run(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::take(std::size_t index, QueuedJob& job) {
+    if (queued.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < queues.size(); ++i) {
+        Queue& queue = *queues[(index + i) % queues.size()];
+        std::lock_guard lock{queue.mutex};
+
+        if (queue.size == 0) {
+            continue;
+        }
+
+        // The owner takes the job it pushed last, its data is likely still in cache. Thieves take the oldest.
+        if (i == 0) {
+            job = queue.jobs[(queue.head + queue.size - 1) % queue.jobs.size()];
+        } else {
+            job = queue.jobs[queue.head];
+            queue.head = (queue.head + 1) % queue.jobs.size();
+        }
+
+        --queue.size;
+        queued.fetch_sub(1);
+
+        return true;
+    }
+
+    return false;
+}
+
+void JobSystem::run(const QueuedJob& job) {
+    job.job.run(job.job.context, job.job.begin, job.job.end);
+    job.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::work(std::size_t index) {
+    worker_owner = this;
+    worker_queue = index;
+
+    FrameArena& frame_arena = FrameArena::instance();
+
+    while (true) {
+        QueuedJob job{};
+
+        if (take(index, job)) {
+            run(job);
+            frame_arena.reset();
+
+            continue;
+        }
+
+        std::unique_lock lock{sleep_mutex};
+        work_ready.wait(lock, [this] {
+            return stopping || queued.load() > 0;
+        });
+
+        if (stopping && queued.load() == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// A unit of work: `run(context, begin, end)`. Plain data so queueing a job never allocates.
+struct Job {
+    void (*run)(void* context, std::size_t begin, std::size_t end);
+    void* context;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+};
+
+// Counts the jobs of one batch that have not finished yet.
+struct JobCounter {
+    std::atomic<std::size_t> pending = 0;
+};
+
+// Fixed pool of workers for the simulation, separate from the asset loader's. Every worker owns a queue it pushes
+// and pops at the back, idle workers steal from the front of the others'. Threads that are not workers share one
+// more queue. Waiting on a counter runs queued jobs instead of blocking, so jobs may submit and wait on jobs too.
+// Jobs must not hand frame arena memory back, a worker resets its arena after each job. Without workers every job
+// runs on the thread that waits for it.
+class JobSystem {
+public:
+    static JobSystem& instance();
+
+    JobSystem() = default;
+
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void start(unsigned int worker_count);
+
+    // Joins the workers once the queues have drained.
+    void shutdown();
+
+    [[nodiscard]] unsigned int worker_count() const {
+        return (unsigned int) workers.size();
+    }
+
+    void submit(JobCounter& counter, Job job);
+
+    // Runs queued jobs until every job counted by `counter` is done.
+    void wait(JobCounter& counter);
+
+    // Calls `body(begin, end)` over [0, count) in chunks of `grain`, one of them on the calling thread.
+    template<typename Body>
+    void parallel_for(std::size_t count, std::size_t grain, const Body& body) {
+        grain = std::max<std::size_t>(grain, 1);
+
+        if (workers.empty() || count <= grain) {
+            if (count > 0) {
+                body(0, count);
+            }
+
+            return;
+        }
+
+        auto run = [](void* context, std::size_t begin, std::size_t end) {
+            (*static_cast<const Body*>(context))(begin, end);
+        };
+
+        JobCounter counter;
+
+        for (std::size_t begin = grain; begin < count; begin += grain) {
+            submit(counter, Job{run, (void*) &body, begin, std::min(begin + grain, count)});
+        }
+
+        body(0, grain);
+        wait(counter);
+    }
+
+private:
+    struct QueuedJob {
+        Job job;
+        JobCounter* counter;
+    };
+
+    // Ring buffer, grows when full and keeps its storage once it has.
+    struct Queue {
+        std::mutex mutex;
+        std::vector<QueuedJob> jobs;
+        std::size_t head = 0;
+        std::size_t size = 0;
+    };
+
+    void work(std::size_t index);
+
+    // Own queue first, then the others in turn.
+    bool take(std::size_t index, QueuedJob& job);
+
+    static void run(const QueuedJob& job);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues; // 0 is shared by threads that are not workers, worker i owns i + 1.
+    std::atomic<std::size_t> queued = 0;
+    std::mutex sleep_mutex;
+    std::condition_variable work_ready;
+    bool stopping = false;
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <raylib.h>
+
+
+constexpr const std::size_t LAYOUT_MAX_PILES = 32;
+constexpr const float LAYOUT_FAN_OFFSET = 16.0F;
+
+enum class DeckType : std::uint8_t {
+    Clubs, // 2 to 10, jack, queen, king, ace.
+    Diamonds,
+    Hearts,
+    Spades,
+    Standard, // All four suits in the order above, 52 cards.
+};
+
+enum class LayoutFace : std::uint8_t {
+    Up,
+    Down,
+    TopUp, // Only the top card is face up.
+};
+
+// One pile of a layout: a slot and the cards dealt onto it.
+struct LayoutPile {
+    float column; // Where the slot goes, in card widths plus spacing from the layout's origin.
+    float row; // In card heights plus spacing.
+    Vector2 fan; // Stack offsets of the slot, every card on it is drawn this much further along.
+    std::uint8_t cards; // Dealt onto it, in deck order.
+    bool rest; // Gets whatever is left of the deck after every other pile instead of `cards`.
+    LayoutFace face;
+};
+
+// A layout pattern parsed into piles, ready to spawn. Fixed size, so it can be built at compile time.
+struct LayoutPlan {
+    std::array<LayoutPile, LAYOUT_MAX_PILES> piles{};
+    std::size_t pile_count = 0;
+    const char* error = nullptr; // Why the pattern did not parse, nullptr when it did.
+    std::size_t error_offset = 0;
+};
+
+// Layout patterns are read one character at a time:
+//   '#'    a pile, one column wide. What follows it, in any order, describes it:
+//     0-9          how many cards to deal onto it, 1 when not given, at most 255. "#0" is an empty slot.
+//     '*'          the rest of the deck, dealt after every other pile.
+//     '^' 'v' '<' '>' '='   fan the cards up (the default), down, left, right, or square them up.
+//     'u' 'd' 't'  all face up (the default), all face down, or only the top card face up.
+//   ' '    separates piles. Every space after the first adds half a column of gap.
+//   '/'    starts the next row.
+// Klondike for example is "#*=d #0    #0 #0 #0 #0 / #1vt #2vt #3vt #4vt #5vt #6vt #7vt".
+constexpr LayoutPlan parse_layout(std::string_view pattern) {
+    LayoutPlan plan;
+    float column = 0.0F;
+    float row = 0.0F;
+    bool after_pile = false;
+
+    auto fail = [&plan](const char* error, std::size_t offset) {
+        plan.error = error;
+        plan.error_offset = offset;
+
+        return plan;
+    };
+
+    for (std::size_t i = 0; i < pattern.size();) {
+        char c = pattern[i];
+
+        if (c == ' ') {
+            std::size_t spaces = 0;
+
+            for (; i < pattern.size() && pattern[i] == ' '; ++i) {
+                ++spaces;
+            }
+
+            column += 0.5F * (float) (after_pile ? spaces - 1 : spaces);
+            after_pile = false;
+
+            continue;
+        }
+
+        if (c == '/') {
+            column = 0.0F;
+            row += 1.0F;
+            after_pile = false;
+            ++i;
+
+            continue;
+        }
+
+        if (c != '#') {
+            return fail("unexpected character", i);
+        }
+
+        if (plan.pile_count == plan.piles.size()) {
+            return fail("too many piles", i);
+        }
+
+        LayoutPile pile{column, row, Vector2{0.0F, -LAYOUT_FAN_OFFSET}, 1, false, LayoutFace::Up};
+        bool counted = false;
+        std::size_t pile_offset = i++;
+
+        for (; i < pattern.size() && pattern[i] != ' ' && pattern[i] != '/' && pattern[i] != '#'; ++i) {
+            char modifier = pattern[i];
+
+            if (modifier >= '0' && modifier <= '9') {
+                unsigned int cards = 0;
+
+                for (; i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9'; ++i) {
+                    cards = cards * 10 + (unsigned int) (pattern[i] - '0');
+
+                    if (cards > 255) {
+                        return fail("more than 255 cards on a pile", pile_offset);
+                    }
+                }
+
+                --i;
+                pile.cards = (std::uint8_t) cards;
+                counted = true;
+            } else if (modifier == '*') {
+                pile.rest = true;
+            } else if (modifier == '^') {
+                pile.fan = Vector2{0.0F, -LAYOUT_FAN_OFFSET};
+            } else if (modifier == 'v') {
+                pile.fan = Vector2{0.0F, LAYOUT_FAN_OFFSET};
+            } else if (modifier == '<') {
+                pile.fan = Vector2{-LAYOUT_FAN_OFFSET, 0.0F};
+            } else if (modifier == '>') {
+                pile.fan = Vector2{LAYOUT_FAN_OFFSET, 0.0F};
+            } else if (modifier == '=') {
+                pile.fan = Vector2{0.0F, 0.0F};
+            } else if (modifier == 'u') {
+                pile.face = LayoutFace::Up;
+            } else if (modifier == 'd') {
+                pile.face = LayoutFace::Down;
+            } else if (modifier == 't') {
+                pile.face = LayoutFace::TopUp;
+            } else {
+                return fail("unknown pile modifier", i);
+            }
+        }
+
+        if (counted && pile.rest) {
+            return fail("a pile with both a count and '*'", pile_offset);
+        }
+
+        plan.piles[plan.pile_count++] = pile;
+        column += 1.0F;
+        after_pile = true;
+    }
+
+    return plan;
+}
+
+// Not constexpr, so a pattern compile_layout can't parse stops the build with this in the error.
+void layout_pattern_is_invalid();
+
+// parse_layout for patterns known at compile time, they cost nothing at runtime and a bad one does not compile.
+consteval LayoutPlan compile_layout(std::string_view pattern) {
+    LayoutPlan plan = parse_layout(pattern);
+
+    if (plan.error) {
+        layout_pattern_is_invalid();
+    }
+
+    return plan;
+}
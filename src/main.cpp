@@ -4,423 +4,369 @@
 #define RAYGUI_IMPLEMENTATION
 
 #include <raygui.h>
-#include <sstream>
-#include <uuid.h>
-#include <ranges>
-#include <deque>
-#include "raymath.h"
+#include <rlgl.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "asset_loader.h"
+#include "autosave.h"
+#include "card_atlas.h"
+#include "fixed_timestep.h"
+#include "frame_arena.h"
+#include "headless.h"
+#include "input_journal.h"
+#include "job_system.h"
+#include "perf_overlay.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "sprite_table.h"
+#include "table.h"
+#include "texture_cache.h"
+
+// CMake points these at the pack it builds and the pngs it is built from, so the game finds its cards whatever the
+// working directory. Other builds look next to where they run.
+#ifndef CARD_GAME_PACK_FILE
+#define CARD_GAME_PACK_FILE "cards.pack"
+#endif
+
+#ifndef CARD_GAME_CARD_DIRECTORY
+#define CARD_GAME_CARD_DIRECTORY "card"
+#endif
 
 
-using EntityId = uuids::uuid;
-
 constexpr const int SCREEN_WIDTH = 1280;
 constexpr const int SCREEN_HEIGHT = 720;
-constexpr const float CARD_WIDTH = 83.25F;
-constexpr const float CARD_HEIGHT = 120.0F;
-
-// TODO: Create a pattern system for generator
-// TODO: Add a way to limit where in a stack of card can a card be dropped. For example certain deck only allows cards to be dropped on the front
-// TODO: Just position still be window space or should it be a normalized world space? Figure out sizing, coordinate space, positioning
-// TODO: Refactor the code into files and proper functions and simple abstractions
-
-struct TransformComponent {
-    explicit TransformComponent(Rectangle rec_) : rec{rec_}, last_rec{rec_}, next_entity{std::nullopt}, prev_entity{std::nullopt} {
-
-    }
-
-    Rectangle rec;
-    Rectangle last_rec;
-    std::optional<EntityId> next_entity; // TODO: Not sure if this should be a part of the transform component. Maybe move this to a Stackable Component
-    std::optional<EntityId> prev_entity; // TODO: Not sure if this should be a part of the transform component. Maybe move this to a Stackable Component
-
-    // TODO: Use GLM Vector
-};
-
-struct RenderComponent {
-    explicit RenderComponent(std::optional<Texture2D> texture_, float offset_x_, float offset_y_) : texture{texture_}, offset_x{offset_x_}, offset_y{offset_y_} {
-
-    }
-
-    std::optional<Texture2D> texture;
-    float offset_x;
-    float offset_y;
-};
-
-struct DraggableComponent {
-    bool is_selected = false;
-};
-
-struct StackableComponent {
-    // TODO: Add stack limit here.
-};
-
-struct Entity {
-    EntityId id;
-    std::optional<TransformComponent> transform;
-    std::optional<RenderComponent> render;
-    std::optional<DraggableComponent> draggable;
-    std::optional<StackableComponent> stackable;
-};
-
-static std::mt19937 rng;
-static auto uuid_rng = uuids::uuid_random_generator(rng);
+constexpr const std::size_t ASSET_UPLOADS_PER_FRAME = 2;
+constexpr const std::uint64_t HEADLESS_DEFAULT_TICKS = 1000000;
+constexpr const char* TRACE_FILE = "card_game_trace.json";
+constexpr const char* REPLAY_FILE = "card_game_replay.cgj";
+constexpr const char* SNAPSHOT_FILE = "card_game_save.cgs";
+constexpr const char* AUTOSAVE_SNAPSHOT_FILE = "card_game_autosave.cgs";
+constexpr const char* AUTOSAVE_JOURNAL_FILE = "card_game_autosave.cga";
+constexpr const GenerationData TABLE_LAYOUT{Vector2{300.0F, 400.0F}, DeckType::Clubs, compile_layout("# # # # # # # # #")};
 
 // TODO: These are globals which is probably bad
-static std::unordered_map<EntityId, Entity> entities; // TODO: This might not be good for performance especially since we loop this quite frequently
-
-Vector2 RecToVec(Rectangle rec) {
-    return Vector2{rec.x - rec.width * 0.5F, rec.y - rec.height * 0.5F};
-}
-
-float RecDistSqr(Rectangle rec1, Rectangle rec2) {
-    return Vector2DistanceSqr(RecToVec(rec1), RecToVec(rec2));
+static Table table{Rectangle{0.0F, 0.0F, (float) SCREEN_WIDTH, (float) SCREEN_HEIGHT}};
+static TextureCache texture_cache;
+static SpriteTable sprite_table;
+static CardAtlas card_atlas;
+static PerfOverlay perf_overlay;
+static DrawStats draw_stats;
+
+// Edges gathered since the last tick go to the next one. A press and a release that land before the same tick are
+// handed to two, so the drop still sees the pick up first.
+static InputFrame take_tick_input(InputFrame& pending) {
+    InputFrame input{pending.pointer, pending.pressed, pending.released && !pending.pressed, pending.undo, pending.redo};
+    pending.pressed = false;
+    pending.released = pending.released && !input.released;
+    pending.undo = false;
+    pending.redo = false;
+
+    return input;
 }
 
-bool close_to(float a, float b, float epsilon) {
-    return fabs(a - b) <= ((fabs(a) < fabs(b) ? fabs(b) : fabs(a)) * epsilon);
+// Texture that DrawRectangle and friends sample, the atlas' white block once it is resident.
+static unsigned int shapes_texture_id() {
+    return card_atlas.texture() != NULL_TEXTURE ? texture_cache.get(card_atlas.texture()).id : rlGetTextureIdDefault();
 }
 
-bool rec_equals(Rectangle rec1, Rectangle rec2) {
-    float ep = 0.01F;
-
-    return close_to(rec1.x, rec2.x, ep) &&
-           close_to(rec1.y, rec2.y, ep) &&
-           close_to(rec1.width, rec2.width, ep) &&
-           close_to(rec1.height, rec2.height, ep);
-}
-
-static bool is_top_entity(Entity* entity) {
-    return !entity->transform->next_entity.has_value();
-}
-
-static Rectangle get_screen_rec(Entity* entity) {
-    if (entity->draggable && entity->draggable->is_selected) {
-        return entity->transform->rec;
-    }
-
-    Rectangle dest{entity->transform->rec};
-    std::optional<EntityId> prev_entity_id = entity->transform->prev_entity;
-
-    while (prev_entity_id.has_value()) {
-        dest.x += entity->render->offset_x;
-        dest.y += entity->render->offset_y;
+// No window, no GPU: generate `table_count` tables, let a bot play each as fast as possible and report the rate.
+static int main_headless(std::uint64_t ticks, std::size_t table_count) {
+    std::vector<std::unique_ptr<Table>> extra_tables;
+    std::vector<Table*> tables{&table};
 
-        Entity& prev_entity = entities.at(*prev_entity_id);
-        prev_entity_id = prev_entity.transform->prev_entity;
+    for (std::size_t i = 1; i < table_count; ++i) {
+        extra_tables.push_back(std::make_unique<Table>(Rectangle{0.0F, 0.0F, (float) SCREEN_WIDTH, (float) SCREEN_HEIGHT}));
+        tables.push_back(extra_tables.back().get());
     }
 
-    return dest;
-}
-
-static int get_stack_index(Entity* entity) {
-    if (entity->draggable && entity->draggable->is_selected) {
-        return 100000;
+    for (Table* headless_table: tables) {
+        SpriteHandle next_sprite = 0;
+        generate_cards(*headless_table, TABLE_LAYOUT, [&next_sprite](std::string_view) {
+            return next_sprite++;
+        });
     }
 
-    int stack_index = 0;
-    std::optional<EntityId> prev_entity_id = entity->transform->prev_entity;
+    HeadlessStats stats = run_headless(tables, ticks, 0);
+    printf("Headless: %zu tables on %u workers, %llu ticks, %llu drops, %llu allocations in %.3fs (%.0f ticks/s)\n",
+           tables.size(), JobSystem::instance().worker_count(), (unsigned long long) stats.ticks, (unsigned long long) stats.drops,
+           (unsigned long long) stats.allocations, stats.seconds, (double) stats.ticks / stats.seconds);
 
-    while (prev_entity_id.has_value()) {
-        ++stack_index;
-        Entity& prev_entity = entities.at(*prev_entity_id);
-        prev_entity_id = prev_entity.transform->prev_entity;
-    }
+    JobSystem::instance().shutdown();
+    table.clear();
 
-    return stack_index;
+    return 0;
 }
 
-Entity* top_entity(const std::function<bool(Entity&)>& predicate) {
-    for (auto& [_, other_entity]: entities) {
-        if (!predicate(other_entity)) {
-            continue;
-        }
+// Plays a journal written with F10 back as fast as possible, checking the table against its state hashes. A journal
+// recorded after loading or recovering a table replays from the snapshot of it the journal carries, `snapshot_file_name`
+// overrides that.
+static int main_replay(const char* file_name, const char* snapshot_file_name) {
+    InputJournal journal;
 
-        if (is_top_entity(&other_entity)) {
-            return &other_entity;
-        }
+    if (!read_input_journal(file_name, journal)) {
+        return 1;
     }
 
-    return nullptr;
-}
-
-// TODO: Is there a way to combine these loops?
-Entity* closest_entity(Rectangle rec, const std::function<bool(Entity&)>& predicate) {
-    float closest_dist = std::numeric_limits<float>::max();
-    Rectangle close_rec;
-
-    for (auto& [_, other_entity]: entities) {
-        if (!predicate(other_entity)) {
-            continue;
-        }
+    // Set up like the windowed game does. Sprites are not part of the state hash, plain numbers stand in for them.
+    SpriteHandle next_sprite = 0;
+    auto sprite_for = [&next_sprite](std::string_view) {
+        return next_sprite++;
+    };
 
-        Rectangle other_rec = get_screen_rec(&other_entity);
-        float dist_to_drop = RecDistSqr(rec, other_rec);
+    if (snapshot_file_name || !journal.base_snapshot.empty()) {
+        Snapshot snapshot;
+        bool is_open = snapshot_file_name ? snapshot.open(snapshot_file_name) : snapshot.open(journal.base_snapshot);
 
-        if (dist_to_drop < closest_dist) {
-            close_rec = other_rec;
-            closest_dist = dist_to_drop;
+        if (!is_open || !table.load_snapshot(snapshot, sprite_for)) {
+            return 1;
         }
+    } else {
+        table.reseed(journal.seed);
+        generate_cards(table, TABLE_LAYOUT, sprite_for);
     }
 
-    std::vector<Entity*> stackable_entities;
-
-    for (auto& [_, other_entity]: entities) {
-        if (!predicate(other_entity)) {
-            continue;
-        }
-
-        if (!(rec_equals(close_rec, get_screen_rec(&other_entity)))) {
-            continue;
-        }
-
-        stackable_entities.push_back(&other_entity);
-    }
+    // Undos recorded past the in-memory history only replay the same through a spill file, like the game has.
+    table.get_history().set_spill_file();
 
-    if (stackable_entities.size() == 1) {
-        return stackable_entities.front();
-    }
+    ReplayStats stats = replay_input_journal(table, journal);
+    printf("Replay: %llu of %llu ticks, %llu checkpoints matched in %.3fs (%.0f ticks/s)\n",
+           (unsigned long long) stats.ticks, (unsigned long long) journal.tick_count, (unsigned long long) stats.checkpoints, stats.seconds,
+           (double) stats.ticks / stats.seconds);
 
-    for (Entity* stackable_entity: stackable_entities) {
-        if (is_top_entity(stackable_entity)) {
-            return stackable_entity;
-        }
+    if (stats.diverged_tick != 0) {
+        printf("Replay diverged at tick %llu.\n", (unsigned long long) stats.diverged_tick);
     }
 
-    return nullptr;
-}
+    JobSystem::instance().shutdown();
+    table.clear();
 
-static void move_to_entity(Entity& entity, const Entity& other_entity) {
-    entity.transform->rec.x = other_entity.transform->rec.x;
-    entity.transform->rec.y = other_entity.transform->rec.y;
+    return stats.diverged_tick != 0 ? 1 : 0;
 }
 
-static void stack_to_entity(Entity& entity_to_stack, Entity& other_entity) {
-    if (!other_entity.stackable) {
-        printf("Unable to stack as the other_entity is not stackable.\n");
-
-        return;
-    }
-
-    if (entity_to_stack.transform->prev_entity.has_value()) {
-        Entity& prev_stack_entity = entities.at(*entity_to_stack.transform->prev_entity);
-        prev_stack_entity.transform->next_entity = entity_to_stack.transform->next_entity;
-    }
+int main(int argc, char** argv) {
+    // The simulation's workers, the asset loader keeps its own.
+    JobSystem::instance().start(std::max(std::thread::hardware_concurrency(), 2U) - 1U);
 
-    if (entity_to_stack.transform->next_entity.has_value()) {
-        Entity& next_stack_entity = entities.at(*entity_to_stack.transform->next_entity);
-        next_stack_entity.transform->prev_entity = entity_to_stack.transform->prev_entity;
+    // --headless [ticks per table] [tables]
+    if (argc > 1 && std::strcmp(argv[1], "--headless") == 0) {
+        return main_headless(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : HEADLESS_DEFAULT_TICKS,
+                             argc > 3 ? std::max<std::size_t>(std::strtoull(argv[3], nullptr, 10), 1) : 1);
     }
 
-
-    entity_to_stack.transform->prev_entity = other_entity.id;
-
-    if (other_entity.transform->next_entity.has_value()) {
-        Entity& next_other_entity = entities.at(*other_entity.transform->next_entity);
-        next_other_entity.transform->prev_entity = entity_to_stack.id;
-        entity_to_stack.transform->next_entity = next_other_entity.id;
+    // --replay [journal] [snapshot]
+    if (argc > 1 && std::strcmp(argv[1], "--replay") == 0) {
+        return main_replay(argc > 2 ? argv[2] : REPLAY_FILE, argc > 3 ? argv[3] : nullptr);
     }
 
-    other_entity.transform->next_entity = entity_to_stack.id;
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Card Game");
 
-    if (entity_to_stack.render.has_value()) {
-        entity_to_stack.render->offset_x = other_entity.render->offset_x;
-        entity_to_stack.render->offset_y = other_entity.render->offset_y;
-    }
+    // Cards are drawn as placeholders until the atlas streams in.
+    AssetLoader asset_loader{std::max(std::thread::hardware_concurrency(), 2U) - 1U};
+    card_atlas.load_async(asset_loader, texture_cache, sprite_table, CARD_GAME_PACK_FILE, CARD_GAME_CARD_DIRECTORY, CARD_ATLAS_HEIGHT);
 
-    move_to_entity(entity_to_stack, other_entity);
-}
+    // Every tick's input is journaled, F10 writes it out so the session can be replayed.
+    InputJournal journal;
+    journal.begin(std::random_device{}());
+    table.reseed(journal.seed);
 
-static Entity& create_card(Vector2 position, std::string_view texture_name, bool is_stackable) {
-    EntityId entity_id = uuid_rng();
+    auto sprite_for = [](std::string_view name) {
+        return sprite_table.find_or_add(name);
+    };
 
-    entities.emplace(entity_id,
-                     Entity{
-                             entity_id,
-                             std::make_optional<TransformComponent>(Rectangle{position.x, position.y, CARD_WIDTH, CARD_HEIGHT}),
-                             std::make_optional<RenderComponent>(std::make_optional<>(LoadTexture(std::format("card/{}.png", texture_name).c_str())), 0.0F, 0.0F),
-                             std::make_optional<DraggableComponent>(),
-                             is_stackable ? std::make_optional<StackableComponent>() : std::nullopt
-                     });
+    auto sprite_name = [](SpriteHandle sprite) {
+        return sprite_table.name(sprite);
+    };
 
-    return entities.at(entity_id);
-}
+    generate_cards(table, TABLE_LAYOUT, sprite_for);
+    SpriteHandle card_back = sprite_for(CARD_BACK_SPRITE);
 
-static Entity& create_slot(Vector2 position, float offset_x, float offset_y) {
-    EntityId entity_id = uuid_rng();
-    entities.emplace(entity_id,
-                     Entity{
-                             entity_id,
-                             std::make_optional<TransformComponent>(Rectangle{position.x, position.y, CARD_WIDTH, CARD_HEIGHT}),
-                             std::make_optional<RenderComponent>(std::nullopt, offset_x, offset_y),
-                             std::nullopt,
-                             std::make_optional<StackableComponent>()
-                     });
-
-    return entities.at(entity_id);
-}
+    // Picks up where the last session stopped, whether it quit or crashed. The journal keeps the recovered table, a
+    // replay could not generate it.
+    if (recover_autosave(table, AUTOSAVE_SNAPSHOT_FILE, AUTOSAVE_JOURNAL_FILE, sprite_for)) {
+        journal.begin(table, sprite_name);
+    }
 
-struct GenerationData {
-    // TODO: Add deck type
-    Vector2 start_position;
-    uint8_t num_of_cards; // TODO: Replace this with a pattern string that we can just draw/generate the cards with. For example: [# # #   #]
-};
+    // Undo reaches back past the in-memory history through a scratch file.
+    table.get_history().set_spill_file();
 
-static void generate_cards(const GenerationData& generation_data) {
-    Vector2 current_position = generation_data.start_position;
+    Autosave autosave;
+    autosave.start(table, AUTOSAVE_SNAPSHOT_FILE, AUTOSAVE_JOURNAL_FILE, sprite_name);
 
-    for (uint8_t i = 0; i < generation_data.num_of_cards; ++i) {
-        Entity& entity_slot = create_slot(current_position, 0.0F, -16.0F);
-        Entity& entity_card = create_card(Vector2{}, std::format("{}_of_clubs", std::to_string(i + 2)), true);
-        stack_to_entity(entity_card, entity_slot);
+    Registry& registry = table.get_registry();
 
-        current_position.x += CARD_WIDTH + 4.0F;
+    for ([[maybe_unused]] EntityHandle entity: registry.view<TransformComponent, DraggableComponent>()) {
+        // Entity Initialization Loop:
     }
-}
 
-int main() {
-    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Card Game");
-
-    generate_cards(GenerationData{Vector2{300.0F, 400.0F}, 9});
+    SetTargetFPS(60);
 
-    for (auto& [_, entity]: entities) {
-        // Entity Initialization Loop:
+    Profiler& profiler = Profiler::instance();
+    profiler.set_enabled(true);
 
-        if (entity.draggable && entity.transform) {
+    FrameArena& frame_arena = FrameArena::instance();
 
-        }
-    }
+    // The simulation ticks at a fixed rate whatever the frame rate, drawing interpolates between the last two ticks.
+    FixedTimestep timestep{SIMULATION_TICKS_PER_SECOND, MAX_TICKS_PER_FRAME};
+    InputFrame pending_input;
 
-    SetTargetFPS(60);
+    while (!WindowShouldClose()) {
+        // The last frame ended at EndDrawing, nothing allocated from the arena during it is alive anymore.
+        frame_arena.reset();
+        profiler.begin_frame();
 
-    bool left_clicked = false;
+        perf_overlay.sample(GetFrameTime(), draw_stats);
+        draw_stats.reset();
 
-    while (!WindowShouldClose()) {
-        std::stringstream text_stream{"Card: ", std::ios_base::app | std::ios_base::out};
+        if (IsKeyPressed(KEY_F3)) {
+            perf_overlay.toggle();
+        }
 
-        // Event
-        if (!left_clicked && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-            left_clicked = true;
-            // User just pressed left click
-
-            // Drag System
-            auto closest_draggable = [](Entity& other_entity) -> bool {
-                // TODO: Handle entities that doesn't stack in the future.
-                if (!(other_entity.transform && other_entity.draggable)) {
-                    return false;
-                }
+        if (IsKeyPressed(KEY_F9) && profiler.write_chrome_trace(TRACE_FILE)) {
+            printf("Wrote the last %zu frames to %s\n", profiler.frame_count(), TRACE_FILE);
+        }
 
-                // TODO: Create a function that creates a rectangle from mouse cursor with some arbitrary size
-                return CheckCollisionPointRec(Vector2{(float) GetMouseX(), (float) GetMouseY()}, get_screen_rec(&other_entity));
-            };
+        if (IsKeyPressed(KEY_F5) && table.write_snapshot(SNAPSHOT_FILE, sprite_name)) {
+            printf("Saved the table to %s\n", SNAPSHOT_FILE);
+        }
 
-            Entity* entity_to_select = top_entity(closest_draggable);
+        if (IsKeyPressed(KEY_F6)) {
+            Snapshot snapshot;
 
-            if (entity_to_select) {
-                entity_to_select->transform->last_rec = entity_to_select->transform->rec;
-                entity_to_select->draggable->is_selected = true;
-            }
-            // =========
-        } else if (left_clicked && IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
-            left_clicked = false;
-            // User just released left click
-
-            for (auto& [_, entity]: entities) {
-                if (entity.draggable && entity.transform) {
-                    // Drop System
-                    if (entity.draggable->is_selected) {
-                        auto closest_stackable = [&entity](Entity& other_entity) -> bool {
-                            if (entity.id == other_entity.id || !other_entity.transform) {
-                                return false;
-                            }
-
-                            return CheckCollisionRecs(get_screen_rec(&entity), get_screen_rec(&other_entity));
-                        };
-
-                        Entity* stackable_entity = closest_entity(get_screen_rec(&entity), closest_stackable);
-
-                        // TODO: Handle entities that doesn't stack in the future.
-                        if (stackable_entity) {
-                            stack_to_entity(entity, *stackable_entity);
-                        } else {
-                            printf("Cannot find stackable entity so moved to last known position.\n");
-                            entity.transform->rec = entity.transform->last_rec;
-                        }
-
-                        entity.transform->last_rec = entity.transform->rec;
-                        entity.draggable->is_selected = false;
-                        // TODO: Trigger an event or a callback or a state change when card was dropped.
-                    }
-                    // ==========
-                }
+            if (snapshot.open(SNAPSHOT_FILE) && table.load_snapshot(snapshot, sprite_for)) {
+                // From here on the journal replays from the snapshot, not from a generated table.
+                journal.begin(table, sprite_name);
+                autosave.compact(table);
+                printf("Loaded the table from %s\n", SNAPSHOT_FILE);
             }
         }
 
+        if (IsKeyPressed(KEY_F10) && write_input_journal(journal, REPLAY_FILE)) {
+            printf("Wrote %llu ticks of input to %s\n", (unsigned long long) journal.tick_count, REPLAY_FILE);
+        }
 
-        // Update
-        for (auto& [_, entity]: entities) {
-            // Entity Update Loop:
-            // TODO: Needs priority for the system update ordering
+        if (!asset_loader.is_idle()) {
+            PROFILE_SCOPE("Asset Upload");
+            ALLOC_SCOPE(AllocTag::Assets);
+            asset_loader.upload(ASSET_UPLOADS_PER_FRAME);
 
-            if (entity.draggable && entity.transform) {
-                if (entity.draggable->is_selected) {
-                    text_stream << "True ";
-                    entity.transform->rec.x = (float) GetMouseX() - entity.transform->rec.width * 0.5F;
-                    entity.transform->rec.y = (float) GetMouseY() - entity.transform->rec.height * 0.5F;
-                } else {
-                    text_stream << "False ";
-                }
+            if (asset_loader.is_idle()) {
+                printf("Textures resident: %zu (%zu KiB)\n", texture_cache.resident_count(), texture_cache.resident_bytes() / 1024);
             }
         }
 
-        std::vector<Entity*> drawable_entities;
+        // Event
+        pending_input.pointer = Vector2{(float) GetMouseX(), (float) GetMouseY()};
+        pending_input.pressed = pending_input.pressed || IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+        pending_input.released = pending_input.released || IsMouseButtonReleased(MOUSE_BUTTON_LEFT);
+
+        // Ctrl+Z undoes, Ctrl+Y or Ctrl+Shift+Z redoes.
+        if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) {
+            bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+            pending_input.undo = pending_input.undo || (IsKeyPressed(KEY_Z) && !shift);
+            pending_input.redo = pending_input.redo || IsKeyPressed(KEY_Y) || (IsKeyPressed(KEY_Z) && shift);
+        }
 
-        for (auto& [_, entity]: entities) {
-            if (entity.transform.has_value() && entity.render.has_value()) {
-                drawable_entities.push_back(&entity);
-            }
+        for (std::uint32_t ticks = timestep.advance(GetFrameTime()); ticks > 0; --ticks) {
+            InputFrame tick_input = take_tick_input(pending_input);
+            table.step(tick_input);
+            journal.record(tick_input, table);
+            autosave.record(table);
         }
 
-        std::sort(drawable_entities.begin(), drawable_entities.end(), [](Entity* entity1, Entity* entity2) {
-            return get_stack_index(entity1) < get_stack_index(entity2);
-        });
+        float alpha = timestep.alpha();
+
+        std::pmr::string text{"Card: ", &frame_arena};
+
+        for (EntityHandle entity: registry.view<TransformComponent, DraggableComponent>()) {
+            text += registry.get<DraggableComponent>(entity).is_selected ? "True " : "False ";
+        }
 
         // Draw
         BeginDrawing();
         {
+            PROFILE_SCOPE("Draw");
+            ALLOC_SCOPE(AllocTag::Draw);
             ClearBackground(LIGHTGRAY);
 
             // Entity Draw Loop:
-            for (Entity* entity: drawable_entities) {
-                if (entity->render->texture.has_value()) {
-                    // Do Render Texture
-                    DrawTexturePro(
-                            *entity->render->texture,
-                            Rectangle{0, 0, (float) entity->render->texture->width, (float) entity->render->texture->height},
-                            get_screen_rec(entity),
-                            Vector2{0.0F, 0.0F},
-                            0.0F,
-                            WHITE
-                    );
-                } else {
-                    // Do Draw Debug Slot
-                    DrawRectangleLinesEx(entity->transform->rec, 2.0F, RED);
+            {
+                PROFILE_SCOPE("Draw Entities");
+
+                for (const RenderList::Entry& entry: table.get_render_list().entries()) {
+                    EntityHandle entity = entry.entity;
+                    const RenderComponent& render = registry.get<RenderComponent>(entity);
+                    Rectangle screen_rec = table.get_interpolated_rec(entity, alpha);
+                    SpriteHandle shown_sprite = render.face_up || render.sprite == NULL_SPRITE ? render.sprite : card_back;
+
+                    if (shown_sprite != NULL_SPRITE && sprite_table.is_ready(shown_sprite)) {
+                        // Do Render Texture
+                        const Sprite& sprite = sprite_table.get(shown_sprite);
+
+                        DrawTexturePro(
+                                texture_cache.get(sprite.texture),
+                                sprite.source,
+                                screen_rec,
+                                Vector2{0.0F, 0.0F},
+                                0.0F,
+                                WHITE
+                        );
+                        draw_stats.count(texture_cache.get(sprite.texture).id, 1);
+                    } else if (shown_sprite != NULL_SPRITE) {
+                        // Do Draw Placeholder Card
+                        DrawRectangleRec(screen_rec, RAYWHITE);
+                        DrawRectangleLinesEx(screen_rec, 1.0F, GRAY);
+                        draw_stats.count(shapes_texture_id(), 1);
+                        draw_stats.count(shapes_texture_id(), 4);
+                    } else {
+                        // Do Draw Debug Slot
+                        DrawRectangleLinesEx(registry.get<TransformComponent>(entity).rec, 2.0F, RED);
+                        draw_stats.count(shapes_texture_id(), 4);
+                    }
                 }
             }
 
-            DrawText(text_stream.str().c_str(), 800 - 200, 100, 18, DARKBLUE);
+            DrawText(text.c_str(), 800 - 200, 100, 18, DARKBLUE);
+            draw_stats.count(GetFontDefault().texture.id, (std::uint32_t) text.size());
+
+            PROFILE_SCOPE("Draw Overlay");
+            perf_overlay.draw(registry, texture_cache);
+        }
+        {
+            // Flushes the last batch and waits on the buffer swap.
+            PROFILE_SCOPE("EndDrawing");
+            ALLOC_SCOPE(AllocTag::Draw);
+            EndDrawing();
         }
-        EndDrawing();
+
+        profiler.end_frame();
     }
 
-    for (auto& [_, entity]: entities) {
-        // Entity Destruct Loop:
-        // TODO: Needs priority for the system destructing
+    // Entity Destruct Loop:
+    // Asset workers may still be decoding into the texture cache, so the workers stop first. The GPU side goes while the window is up.
+    Scheduler teardown;
 
-        if (entity.render) {
-            // Destruct Render Texture
-            UnloadTexture(*entity.render->texture);
-        }
-    }
+    teardown.add("Shutdown Workers", 0, SystemAccess{}, [&asset_loader, &autosave] {
+        autosave.stop();
+        asset_loader.shutdown();
+        JobSystem::instance().shutdown();
+    });
+
+    teardown.add("Destruct Render Texture", 100, SystemAccess{}, [] {
+        sprite_table.clear(texture_cache);
+        card_atlas.release(texture_cache);
+        texture_cache.clear();
+    });
+
+    teardown.add("Destruct Table", 200, SystemAccess{}.write<TransformComponent, RenderComponent, DraggableComponent, StackableComponent, StackComponent>(), [] {
+        table.clear();
+    });
+
+    teardown.run();
 
     CloseWindow();
 
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <type_traits>
+#include "move_history.h"
+#include "table.h"
+
+
+// The spill file never outlives the process, so drops are written as they are in memory.
+static_assert(std::is_trivially_copyable_v<DropEvent>);
+
+MoveHistory::~MoveHistory() {
+    if (spill_file) {
+        fclose(spill_file);
+    }
+}
+
+bool MoveHistory::set_spill_file() {
+    if (spill_file) {
+        fclose(spill_file);
+    }
+
+    // Every history gets its own anonymous file, so two tables or two running games never share one.
+    spill_file = std::tmpfile();
+    clear();
+
+    if (!spill_file) {
+        printf("Unable to open a spill file for the move history.\n");
+
+        return false;
+    }
+
+    return true;
+}
+
+void MoveHistory::record(const DropEvent& drop) {
+    if (ring.empty()) {
+        ring.resize(MOVE_HISTORY_CAPACITY);
+    }
+
+    // Forget the undone drops, and since the new one goes right after `done`, anything the ring holds of them.
+    count = done;
+    ring_size = std::min(ring_size, done - ring_begin);
+
+    if (ring_size == ring.size()) {
+        evict(false);
+    }
+
+    at(done) = drop;
+    ++ring_size;
+    ++done;
+    ++count;
+}
+
+const DropEvent* MoveHistory::undo(Table& table) {
+    if (done == first || (done - 1 < ring_begin && !load(done - 1))) {
+        return nullptr;
+    }
+
+    --done;
+    const DropEvent& drop = at(done);
+    table.revert_drop(drop);
+
+    return &drop;
+}
+
+const DropEvent* MoveHistory::redo(Table& table) {
+    if (done == count || (done >= ring_begin + ring_size && !load(done))) {
+        return nullptr;
+    }
+
+    const DropEvent& drop = at(done);
+    ++done;
+    table.apply_drop(drop);
+
+    return &drop;
+}
+
+void MoveHistory::clear() {
+    ring_begin = 0;
+    ring_size = 0;
+    first = 0;
+    done = 0;
+    count = 0;
+}
+
+bool MoveHistory::evict(bool newest) {
+    std::size_t index = newest ? ring_begin + ring_size - 1 : ring_begin;
+
+    bool written = spill_file && fseek(spill_file, (long) (index * sizeof(DropEvent)), SEEK_SET) == 0 &&
+                   fwrite(&at(index), sizeof(DropEvent), 1, spill_file) == 1;
+
+    if (!written) {
+        // What is not on disk is gone, from the evicted end onwards.
+        if (newest) {
+            count = index;
+        } else {
+            first = index + 1;
+        }
+    }
+
+    if (!newest) {
+        ++ring_begin;
+    }
+
+    --ring_size;
+
+    return written;
+}
+
+bool MoveHistory::load(std::size_t index) {
+    if (!spill_file) {
+        return false;
+    }
+
+    // Undo loads below the ring and gives up its newest drop, redo loads above it and gives up its oldest.
+    bool below = index < ring_begin;
+
+    if (ring_size == ring.size()) {
+        evict(below);
+    }
+
+    DropEvent drop{};
+
+    if (fseek(spill_file, (long) (index * sizeof(DropEvent)), SEEK_SET) != 0 || fread(&drop, sizeof(DropEvent), 1, spill_file) != 1) {
+        printf("Unable to read the move history back from its spill file.\n");
+
+        if (below) {
+            first = index + 1;
+        } else {
+            count = index;
+        }
+
+        return false;
+    }
+
+    at(index) = drop;
+    ring_begin = below ? index : ring_begin;
+    ++ring_size;
+
+    return true;
+}
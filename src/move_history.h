@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include "drop_event.h"
+
+
+constexpr const std::size_t MOVE_HISTORY_CAPACITY = 512;
+
+class Table;
+
+// Drops that can be undone, oldest first, followed by the undone ones that can be redone. A ring keeps the
+// MOVE_HISTORY_CAPACITY around the current one in memory. Those that leave it go to a spill file when one is set, at
+// their place in the history, and are read back as undo or redo reaches them. Without a spill file, drops that fall
+// out of the ring are forgotten. Undoing or redoing a drop costs the cards it moved, whatever the size of the table
+// or the history.
+class MoveHistory {
+public:
+    MoveHistory() = default;
+
+    ~MoveHistory();
+
+    MoveHistory(const MoveHistory&) = delete;
+
+    MoveHistory& operator=(const MoveHistory&) = delete;
+
+    // Opens a scratch file for drops that leave the ring. It is a std::tmpfile, gone with the history or the process.
+    bool set_spill_file();
+
+    // Adds a drop that was just made. What could be redone is forgotten.
+    void record(const DropEvent& drop);
+
+    // Reverts the newest drop that is not undone yet and returns it, or nullptr if there is none.
+    const DropEvent* undo(Table& table);
+
+    // Makes the oldest undone drop again and returns it, or nullptr if there is none.
+    const DropEvent* redo(Table& table);
+
+    [[nodiscard]] bool can_undo() const {
+        return done > first;
+    }
+
+    [[nodiscard]] bool can_redo() const {
+        return done < count;
+    }
+
+    void clear();
+
+private:
+    [[nodiscard]] DropEvent& at(std::size_t index) {
+        return ring[index % ring.size()];
+    }
+
+    // Makes room in a full ring by writing out its oldest drop, or its newest when `newest`.
+    bool evict(bool newest);
+
+    // Brings drop `index` into the ring next to the ones already there.
+    bool load(std::size_t index);
+
+    // Drops are numbered by their place in the whole history, drop `index` lives in ring slot `index % capacity`.
+    std::vector<DropEvent> ring;
+    std::size_t ring_begin = 0; // Oldest drop in the ring.
+    std::size_t ring_size = 0;
+    std::size_t first = 0; // Oldest drop that can still be undone, older ones were forgotten.
+    std::size_t done = 0; // Drops before this are made, the rest are undone.
+    std::size_t count = 0;
+    FILE* spill_file = nullptr;
+};
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <raygui.h>
+#include <rlgl.h>
+#include "frame_arena.h"
+#include "perf_overlay.h"
+#include "profiler.h"
+
+
+// rlgl only defines its vertex limit once a graphics API is picked, desktop GL is the default build.
+#ifdef RL_DEFAULT_BATCH_BUFFER_ELEMENTS
+constexpr const std::uint32_t BATCH_QUADS = RL_DEFAULT_BATCH_BUFFER_ELEMENTS;
+#else
+constexpr const std::uint32_t BATCH_QUADS = 8192;
+#endif
+
+constexpr const float OVERLAY_X = 10.0F;
+constexpr const float OVERLAY_Y = 10.0F;
+constexpr const float OVERLAY_WIDTH = 340.0F;
+constexpr const float OVERLAY_LINE = 18.0F;
+constexpr const float OVERLAY_PADDING = 8.0F;
+constexpr const float HISTOGRAM_HEIGHT = 60.0F;
+constexpr const float HISTOGRAM_MAX_MS = 33.3F;
+constexpr const float TARGET_FRAME_MS = 16.7F;
+constexpr const std::size_t OVERLAY_MAX_PHASES = 32;
+
+void DrawStats::count(unsigned int texture_id_, std::uint32_t quads_) {
+    if (draw_calls == 0 || texture_id != texture_id_) {
+        ++texture_switches;
+        texture_id = texture_id_;
+    }
+
+    ++draw_calls;
+    quads += quads_;
+}
+
+std::uint32_t DrawStats::batch_flushes() const {
+    return 1 + texture_switches / RL_DEFAULT_BATCH_DRAWCALLS + quads / BATCH_QUADS;
+}
+
+void DrawStats::reset() {
+    *this = DrawStats{};
+}
+
+void PerfOverlay::sample(float frame_seconds, const DrawStats& draw_stats) {
+    frame_times[next_frame] = frame_seconds * 1000.0F;
+    next_frame = (next_frame + 1) % OVERLAY_FRAME_HISTORY;
+    last_draw_stats = draw_stats;
+
+    AllocationCounts allocations = allocation_counts();
+    frame_allocations = AllocationCounts{allocations.calls - allocations_at_sample.calls, allocations.bytes - allocations_at_sample.bytes};
+    allocations_at_sample = allocations;
+
+    for (std::size_t tag = 0; tag < ALLOC_TAG_COUNT; ++tag) {
+        std::uint64_t calls = allocation_tag_counts((AllocTag) tag).calls;
+        tag_frame_allocations[tag] = calls - tag_allocations_at_sample[tag];
+        tag_allocations_at_sample[tag] = calls;
+    }
+}
+
+void PerfOverlay::draw(Registry& registry, const TextureCache& texture_cache) const {
+    if (!visible) {
+        return;
+    }
+
+    // Phases in the order they started, the profiler stores them in the order they ended.
+    std::array<const ProfileEvent*, OVERLAY_MAX_PHASES> phases{};
+    std::size_t phase_count = 0;
+    const Profiler& profiler = Profiler::instance();
+
+    if (profiler.frame_count() > 0) {
+        for (const ProfileEvent& event: profiler.frame(0).events) {
+            if (phase_count == phases.size()) {
+                break;
+            }
+
+            phases[phase_count++] = &event;
+        }
+
+        std::sort(phases.begin(), phases.begin() + (std::ptrdiff_t) phase_count, [](const ProfileEvent* a, const ProfileEvent* b) {
+            return a->start_ns < b->start_ns;
+        });
+    }
+
+    std::size_t lines = 16 + std::max<std::size_t>(phase_count, 1) + (allocation_tracking_enabled() ? 2 : 0);
+    float height = OVERLAY_PADDING * 2.0F + HISTOGRAM_HEIGHT + OVERLAY_LINE * (float) lines;
+    GuiPanel(Rectangle{OVERLAY_X, OVERLAY_Y, OVERLAY_WIDTH, height}, "Performance (F3)");
+
+    float x = OVERLAY_X + OVERLAY_PADDING;
+    float y = OVERLAY_Y + OVERLAY_PADDING + OVERLAY_LINE;
+    float width = OVERLAY_WIDTH - OVERLAY_PADDING * 2.0F;
+
+    auto label = [&y, x, width](const char* text, float indent = 0.0F) {
+        GuiLabel(Rectangle{x + indent, y, width - indent, OVERLAY_LINE}, text);
+        y += OVERLAY_LINE;
+    };
+
+    auto line = [&y, x, width](const char* text) {
+        GuiLine(Rectangle{x, y, width, OVERLAY_LINE}, text);
+        y += OVERLAY_LINE;
+    };
+
+    // Frame Time
+    float total_ms = 0.0F;
+    float max_ms = 0.0F;
+
+    for (float frame_ms: frame_times) {
+        total_ms += frame_ms;
+        max_ms = std::max(max_ms, frame_ms);
+    }
+
+    float last_ms = frame_times[(next_frame + OVERLAY_FRAME_HISTORY - 1) % OVERLAY_FRAME_HISTORY];
+    label(TextFormat("Frame %.2f ms  avg %.2f  max %.2f", last_ms, total_ms / (float) OVERLAY_FRAME_HISTORY, max_ms));
+
+    float bar_width = width / (float) OVERLAY_FRAME_HISTORY;
+
+    for (std::size_t i = 0; i < OVERLAY_FRAME_HISTORY; ++i) {
+        float frame_ms = frame_times[(next_frame + i) % OVERLAY_FRAME_HISTORY];
+        float bar_height = std::min(frame_ms / HISTOGRAM_MAX_MS, 1.0F) * HISTOGRAM_HEIGHT;
+        Color color = frame_ms <= TARGET_FRAME_MS ? LIME : (frame_ms <= HISTOGRAM_MAX_MS ? ORANGE : RED);
+        DrawRectangleRec(Rectangle{x + (float) i * bar_width, y + HISTOGRAM_HEIGHT - bar_height, bar_width, bar_height}, color);
+    }
+
+    float target_y = y + HISTOGRAM_HEIGHT - TARGET_FRAME_MS / HISTOGRAM_MAX_MS * HISTOGRAM_HEIGHT;
+    DrawLineEx(Vector2{x, target_y}, Vector2{x + width, target_y}, 1.0F, DARKGRAY);
+    y += HISTOGRAM_HEIGHT;
+
+    // Phases
+    line("Phases (last frame)");
+
+    if (phase_count == 0) {
+        label("Profiler disabled");
+    }
+
+    for (std::size_t i = 0; i < phase_count; ++i) {
+        label(TextFormat("%-16s %8.3f ms", phases[i]->name, (double) phases[i]->duration_ns / 1e6), (float) phases[i]->depth * 12.0F);
+    }
+
+    // Entities
+    line("Entities");
+    label(TextFormat("Total %zu", registry.size()));
+    label(TextFormat("Transform %zu  Render %zu", registry.storage<TransformComponent>().size(), registry.storage<RenderComponent>().size()));
+    label(TextFormat("Draggable %zu  Stackable %zu  Stack %zu", registry.storage<DraggableComponent>().size(),
+                     registry.storage<StackableComponent>().size(), registry.storage<StackComponent>().size()));
+
+    // Draw
+    line("Draw");
+    label(TextFormat("Draw calls %u  Quads %u", last_draw_stats.draw_calls, last_draw_stats.quads));
+    label(TextFormat("GPU draws %u  Batch flushes ~%u", last_draw_stats.texture_switches, last_draw_stats.batch_flushes()));
+
+    // Memory
+    line("Memory");
+    label(TextFormat("Textures %zu (%zu KiB)", texture_cache.resident_count(), texture_cache.resident_bytes() / 1024));
+    const FrameArena& frame_arena = FrameArena::instance();
+    label(TextFormat("Frame arena %zu / %zu KiB  overflow %zu B", frame_arena.peak() / 1024, frame_arena.capacity() / 1024, frame_arena.overflow_bytes()));
+    label(TextFormat("Allocations %llu (%llu B) per frame", (unsigned long long) frame_allocations.calls, (unsigned long long) frame_allocations.bytes));
+
+    if (allocation_tracking_enabled()) {
+        label(TextFormat("Event %llu  Update %llu  Draw %llu  Assets %llu  Other %llu",
+                         (unsigned long long) tag_frame_allocations[(std::size_t) AllocTag::Event],
+                         (unsigned long long) tag_frame_allocations[(std::size_t) AllocTag::Update],
+                         (unsigned long long) tag_frame_allocations[(std::size_t) AllocTag::Draw],
+                         (unsigned long long) tag_frame_allocations[(std::size_t) AllocTag::Assets],
+                         (unsigned long long) tag_frame_allocations[(std::size_t) AllocTag::Untagged]), 12.0F);
+        label(TextFormat("Heap live %zu KiB  peak %zu KiB", allocation_live_bytes() / 1024, allocation_peak_bytes() / 1024));
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "allocation_counter.h"
+#include "registry.h"
+#include "texture_cache.h"
+
+
+constexpr const std::size_t OVERLAY_FRAME_HISTORY = 120;
+
+// What the front end submitted to rlgl this frame. rlgl starts a new GPU draw call whenever the texture changes and
+// flushes the whole batch at EndDrawing or when it runs out of draw calls or vertex space.
+struct DrawStats {
+    std::uint32_t draw_calls = 0; // raylib draw functions called.
+    std::uint32_t quads = 0;
+    std::uint32_t texture_switches = 0; // Each one is a separate GPU draw call inside the batch.
+    unsigned int texture_id = 0;
+
+    void count(unsigned int texture_id_, std::uint32_t quads_);
+
+    // Estimated from the limits rlgl was built with, rlgl does not expose its counters.
+    [[nodiscard]] std::uint32_t batch_flushes() const;
+
+    void reset();
+};
+
+// Toggleable raygui panel for diagnosing a slow table live: frame time history, the profiler's phases of the last
+// frame, entities per component, draw submission, resident textures and allocations per frame.
+class PerfOverlay {
+public:
+    void toggle() {
+        visible = !visible;
+    }
+
+    [[nodiscard]] bool is_visible() const {
+        return visible;
+    }
+
+    // Call once per frame with the previous frame's time and draw stats.
+    void sample(float frame_seconds, const DrawStats& draw_stats);
+
+    void draw(Registry& registry, const TextureCache& texture_cache) const;
+
+private:
+    std::array<float, OVERLAY_FRAME_HISTORY> frame_times{};
+    std::size_t next_frame = 0;
+    DrawStats last_draw_stats;
+    AllocationCounts allocations_at_sample;
+    AllocationCounts frame_allocations;
+    std::array<std::uint64_t, ALLOC_TAG_COUNT> tag_allocations_at_sample{};
+    std::array<std::uint64_t, ALLOC_TAG_COUNT> tag_frame_allocations{};
+    bool visible = false;
+};
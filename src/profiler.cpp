@@ -0,0 +1,143 @@
+#include <cstdio>
+#include "profiler.h"
+
+
+constexpr const std::size_t PROFILER_EVENTS_PER_FRAME = 64;
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+
+    return profiler;
+}
+
+Profiler::Profiler() : epoch{std::chrono::steady_clock::now()} {
+    for (ProfileFrame& frame: frames) {
+        frame.events.reserve(PROFILER_EVENTS_PER_FRAME);
+    }
+}
+
+void Profiler::begin_frame() {
+    if (!enabled) {
+        return;
+    }
+
+    ProfileFrame& frame = frames[completed % PROFILER_FRAMES];
+    frame.index = completed;
+    frame.start_ns = now_ns();
+    frame.duration_ns = 0;
+    frame.events.clear();
+    depth = 0;
+    in_frame = true;
+    is_frame_thread = true;
+
+    allocations_at_begin = allocation_counts();
+
+    for (std::size_t tag = 0; tag < ALLOC_TAG_COUNT; ++tag) {
+        tag_allocations_at_begin[tag] = allocation_tag_counts((AllocTag) tag).calls;
+    }
+}
+
+void Profiler::end_frame() {
+    if (!in_frame) {
+        return;
+    }
+
+    ProfileFrame& frame = frames[completed % PROFILER_FRAMES];
+    frame.duration_ns = now_ns() - frame.start_ns;
+    in_frame = false;
+
+    AllocationCounts allocations = allocation_counts();
+    frame.allocations = AllocationCounts{allocations.calls - allocations_at_begin.calls, allocations.bytes - allocations_at_begin.bytes};
+    frame.live_bytes = allocation_live_bytes();
+
+    for (std::size_t tag = 0; tag < ALLOC_TAG_COUNT; ++tag) {
+        frame.tag_allocations[tag] = allocation_tag_counts((AllocTag) tag).calls - tag_allocations_at_begin[tag];
+    }
+    ++completed;
+}
+
+void Profiler::leave_scope(const char* name, std::int64_t start_ns, std::uint32_t scope_depth) {
+    depth = scope_depth;
+
+    // The frame ended or the profiler got disabled while the scope was open.
+    if (!in_frame) {
+        return;
+    }
+
+    frames[completed % PROFILER_FRAMES].events.push_back(ProfileEvent{name, start_ns, now_ns() - start_ns, scope_depth});
+}
+
+const ProfileFrame& Profiler::frame(std::size_t age) const {
+    return frames[(completed - 1 - age) % PROFILER_FRAMES];
+}
+
+std::int64_t Profiler::scope_ns(const ProfileFrame& frame, std::string_view name) {
+    std::int64_t total = 0;
+
+    for (const ProfileEvent& event: frame.events) {
+        if (name == event.name) {
+            total += event.duration_ns;
+        }
+    }
+
+    return total;
+}
+
+bool Profiler::write_chrome_trace(const char* file) const {
+    FILE* trace = fopen(file, "w");
+
+    if (!trace) {
+        printf("Unable to open %s for writing.\n", file);
+
+        return false;
+    }
+
+    fprintf(trace, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+
+    // Oldest frame first, timestamps and durations in microseconds.
+    for (std::size_t age = frame_count(); age-- > 0;) {
+        const ProfileFrame& profile_frame = frame(age);
+
+        fprintf(trace, R"(%s{"name": "Frame", "ph": "X", "pid": 1, "tid": 1, "ts": %.3f, "dur": %.3f, "args": {"index": %llu}})",
+                first ? "" : ",\n", (double) profile_frame.start_ns / 1000.0, (double) profile_frame.duration_ns / 1000.0,
+                (unsigned long long) profile_frame.index);
+        first = false;
+
+        // Counter tracks, drawn as graphs above the thread.
+        fprintf(trace, ",\n" R"({"name": "Heap Allocations", "ph": "C", "pid": 1, "ts": %.3f, "args": {"calls": %llu, "bytes": %llu}})",
+                (double) profile_frame.start_ns / 1000.0, (unsigned long long) profile_frame.allocations.calls,
+                (unsigned long long) profile_frame.allocations.bytes);
+
+        if (allocation_tracking_enabled()) {
+            fprintf(trace, ",\n" R"({"name": "Heap Live", "ph": "C", "pid": 1, "ts": %.3f, "args": {"KiB": %zu}})",
+                    (double) profile_frame.start_ns / 1000.0, profile_frame.live_bytes / 1024);
+            fprintf(trace, ",\n" R"({"name": "Allocations By Tag", "ph": "C", "pid": 1, "ts": %.3f, "args": {)", (double) profile_frame.start_ns / 1000.0);
+
+            for (std::size_t tag = 0; tag < ALLOC_TAG_COUNT; ++tag) {
+                fprintf(trace, R"(%s"%s": %llu)", tag == 0 ? "" : ", ", alloc_tag_name((AllocTag) tag), (unsigned long long) profile_frame.tag_allocations[tag]);
+            }
+
+            fprintf(trace, "}}");
+        }
+
+        for (const ProfileEvent& event: profile_frame.events) {
+            fprintf(trace, R"(,)" "\n" R"({"name": "%s", "ph": "X", "pid": 1, "tid": 1, "ts": %.3f, "dur": %.3f})",
+                    event.name, (double) event.start_ns / 1000.0, (double) event.duration_ns / 1000.0);
+        }
+    }
+
+    fprintf(trace, "\n]}\n");
+
+    return fclose(trace) == 0;
+}
+
+void Profiler::clear() {
+    for (ProfileFrame& frame: frames) {
+        frame.events.clear();
+    }
+
+    completed = 0;
+    depth = 0;
+    in_frame = false;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "allocation_counter.h"
+
+
+constexpr const std::size_t PROFILER_FRAMES = 240;
+
+struct ProfileEvent {
+    const char* name; // Must outlive the profiler, scopes use string literals.
+    std::int64_t start_ns;
+    std::int64_t duration_ns;
+    std::uint32_t depth;
+};
+
+struct ProfileFrame {
+    std::uint64_t index = 0;
+    std::int64_t start_ns = 0;
+    std::int64_t duration_ns = 0;
+    std::vector<ProfileEvent> events; // In the order scopes closed, so children come before their parent.
+    AllocationCounts allocations; // Heap allocations during the frame, on all threads.
+    std::size_t live_bytes = 0; // Heap in use at the end of the frame, only with CARD_GAME_ALLOC_TRACKING.
+    std::array<std::uint64_t, ALLOC_TAG_COUNT> tag_allocations{}; // Likewise.
+};
+
+// Frame profiler for the main thread. Scopes are recorded into a ring of the last PROFILER_FRAMES frames, whose
+// event storage is reused so a warmed up profiler does not allocate. When disabled a scope costs one branch, scopes
+// opened on other threads are not recorded.
+class Profiler {
+public:
+    static Profiler& instance();
+
+    void set_enabled(bool enabled_) {
+        enabled = enabled_;
+    }
+
+    [[nodiscard]] bool is_enabled() const {
+        return enabled;
+    }
+
+    // Scopes only record between begin_frame and end_frame, on the thread that called begin_frame.
+    [[nodiscard]] bool is_recording() const {
+        return is_frame_thread && enabled && in_frame;
+    }
+
+    void begin_frame();
+
+    void end_frame();
+
+    [[nodiscard]] std::int64_t now_ns() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // Returns the depth of the scope being opened.
+    std::uint32_t enter_scope() {
+        return depth++;
+    }
+
+    void leave_scope(const char* name, std::int64_t start_ns, std::uint32_t scope_depth);
+
+    // Completed frames currently held, at most PROFILER_FRAMES.
+    [[nodiscard]] std::size_t frame_count() const {
+        return completed < PROFILER_FRAMES ? (std::size_t) completed : PROFILER_FRAMES;
+    }
+
+    // `age` 0 is the most recently completed frame.
+    [[nodiscard]] const ProfileFrame& frame(std::size_t age) const;
+
+    // Total time spent in scopes called `name` during the frame.
+    [[nodiscard]] static std::int64_t scope_ns(const ProfileFrame& frame, std::string_view name);
+
+    // Writes every held frame as Chrome trace event JSON, loadable in about:tracing and Perfetto.
+    bool write_chrome_trace(const char* file) const;
+
+    void clear();
+
+private:
+    Profiler();
+
+    std::array<ProfileFrame, PROFILER_FRAMES> frames;
+    std::uint64_t completed = 0;
+    std::uint32_t depth = 0;
+    AllocationCounts allocations_at_begin;
+    std::array<std::uint64_t, ALLOC_TAG_COUNT> tag_allocations_at_begin{};
+    bool enabled = false;
+    bool in_frame = false;
+    std::chrono::steady_clock::time_point epoch;
+
+    // Checked first, scopes on job workers never touch the shared state.
+    static inline thread_local bool is_frame_thread = false;
+};
+
+// Records the time between construction and destruction as a scope of the current frame.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name_) : name{name_}, recording{Profiler::instance().is_recording()} {
+        if (recording) {
+            depth = Profiler::instance().enter_scope();
+            start_ns = Profiler::instance().now_ns();
+        }
+    }
+
+    ~ProfileScope() {
+        if (recording) {
+            Profiler::instance().leave_scope(name, start_ns, depth);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    bool recording;
+    std::uint32_t depth = 0;
+    std::int64_t start_ns = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef CARD_GAME_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__){name}
+#else
+#define PROFILE_SCOPE(name)
+#endif
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cstdio>
+#include "registry.h"
+
+
+EntityHandle Registry::create(EntityId id) {
+    EntityIndex index;
+
+    if (!free_indices.empty()) {
+        index = free_indices.back();
+        free_indices.pop_back();
+        ids[index] = id;
+    } else {
+        index = static_cast<EntityIndex>(generations.size());
+
+        if (index > EntityHandle::INDEX_MASK) {
+            printf("Unable to create entity as the registry is full.\n");
+
+            return NULL_ENTITY;
+        }
+
+        generations.push_back(0);
+        ids.push_back(id);
+    }
+
+    EntityHandle entity{index, generations[index]};
+    ++live_count;
+
+    if (is_indexed) {
+        handle_by_id.emplace(id, entity);
+    }
+
+    return entity;
+}
+
+void Registry::destroy(EntityHandle entity) {
+    if (!is_valid(entity)) {
+        return;
+    }
+
+    std::apply([entity](auto& ... pool) {
+        (pool.remove(entity), ...);
+    }, pools);
+
+    EntityIndex index = entity.index();
+    --live_count;
+
+    if (is_indexed) {
+        handle_by_id.erase(ids[index]);
+    }
+
+    ids[index] = EntityId{};
+
+    // A slot whose generation would wrap is retired instead of reused, so old handles can never become valid again.
+    if (++generations[index] < EntityHandle::MAX_GENERATION) {
+        free_indices.push_back(index);
+    }
+}
+
+void Registry::clear() {
+    std::apply([](auto& ... pool) {
+        (pool.clear(), ...);
+    }, pools);
+
+    generations.clear();
+    ids.clear();
+    free_indices.clear();
+    live_count = 0;
+    handle_by_id.clear();
+    is_indexed = true;
+}
+
+void Registry::restore(std::vector<std::uint32_t> generations_, std::vector<EntityId> ids_, std::vector<EntityIndex> free_indices_) {
+    clear();
+
+    generations = std::move(generations_);
+    ids = std::move(ids_);
+    free_indices = std::move(free_indices_);
+    live_count = (std::size_t) std::count_if(ids.begin(), ids.end(), [](const EntityId& id) {
+        return !id.is_nil();
+    });
+
+    // Hashing every id is most of what a restore would cost, and only lookups by id need it.
+    is_indexed = false;
+}
+
+EntityId Registry::id(EntityHandle entity) const {
+    return ids[entity.index()];
+}
+
+EntityHandle Registry::find(EntityId id) const {
+    if (!is_indexed) {
+        handle_by_id.reserve(live_count);
+
+        for (EntityIndex index = 0; index < ids.size(); ++index) {
+            if (!ids[index].is_nil()) {
+                handle_by_id.emplace(ids[index], EntityHandle{index, generations[index]});
+            }
+        }
+
+        is_indexed = true;
+    }
+
+    auto it = handle_by_id.find(id);
+
+    return it != handle_by_id.end() ? it->second : NULL_ENTITY;
+}
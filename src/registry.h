@@ -0,0 +1,144 @@
+#pragma once
+
+#include <ranges>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "components.h"
+#include "sparse_set.h"
+
+
+// Owns every entity and one SparseSet per component type.
+// The EntityId <-> EntityHandle tables are only for serialization and networking; nothing per-frame should touch them.
+class Registry {
+public:
+    // Every component type, one pool each.
+    using Pools = std::tuple<
+            SparseSet<TransformComponent>,
+            SparseSet<RenderComponent>,
+            SparseSet<DraggableComponent>,
+            SparseSet<StackableComponent>,
+            SparseSet<StackComponent>
+    >;
+
+    EntityHandle create(EntityId id);
+
+    void destroy(EntityHandle entity);
+
+    void clear();
+
+    [[nodiscard]] bool is_valid(EntityHandle entity) const {
+        return entity.index() < generations.size() && generations[entity.index()] == entity.generation();
+    }
+
+    [[nodiscard]] EntityId id(EntityHandle entity) const;
+
+    // Returns NULL_ENTITY if no live entity has that id. The first call after a restore builds the id table, which is
+    // not safe to race with other calls.
+    [[nodiscard]] EntityHandle find(EntityId id) const;
+
+    [[nodiscard]] std::size_t size() const {
+        return live_count;
+    }
+
+    // Slot state by entity index, for saving the registry. Dead slots have a nil id.
+    [[nodiscard]] const std::vector<std::uint32_t>& slot_generations() const {
+        return generations;
+    }
+
+    [[nodiscard]] const std::vector<EntityId>& slot_ids() const {
+        return ids;
+    }
+
+    [[nodiscard]] const std::vector<EntityIndex>& free_slots() const {
+        return free_indices;
+    }
+
+    // Replaces every slot with saved ones and empties the pools, the caller emplaces the components after. The id
+    // table is left for `find` to build.
+    void restore(std::vector<std::uint32_t> generations_, std::vector<EntityId> ids_, std::vector<EntityIndex> free_indices_);
+
+    // Position of T's pool, the same for the whole run. Used for component access masks.
+    template<typename T>
+    static constexpr std::size_t component_index() {
+        return pool_index<SparseSet<T>>(static_cast<Pools*>(nullptr));
+    }
+
+    static constexpr std::size_t COMPONENT_COUNT = std::tuple_size_v<Pools>;
+
+    template<typename T>
+    SparseSet<T>& storage() {
+        return std::get<SparseSet<T>>(pools);
+    }
+
+    template<typename T>
+    const SparseSet<T>& storage() const {
+        return std::get<SparseSet<T>>(pools);
+    }
+
+    template<typename T, typename... Args>
+    T& emplace(EntityHandle entity, Args&& ... args) {
+        return storage<T>().emplace(entity, std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    void remove(EntityHandle entity) {
+        storage<T>().remove(entity);
+    }
+
+    template<typename T>
+    [[nodiscard]] bool has(EntityHandle entity) const {
+        return storage<T>().contains(entity);
+    }
+
+    template<typename... Ts>
+    [[nodiscard]] bool has_all(EntityHandle entity) const {
+        return (has<Ts>(entity) && ...);
+    }
+
+    template<typename T>
+    T& get(EntityHandle entity) {
+        return storage<T>().get(entity);
+    }
+
+    template<typename T>
+    T* try_get(EntityHandle entity) {
+        return storage<T>().try_get(entity);
+    }
+
+    // Entities owning all of Ts. Walks the smallest of the sets and filters by the rest.
+    // Adding or removing any of Ts while iterating is not allowed.
+    template<typename... Ts>
+    auto view() {
+        return smallest<Ts...>() | std::views::filter([this](EntityHandle entity) {
+            return has_all<Ts...>(entity);
+        });
+    }
+
+private:
+    template<typename Pool, typename... Ts>
+    static constexpr std::size_t pool_index(std::tuple<Ts...>*) {
+        std::size_t index = 0;
+        bool found = false;
+        ((found = found || std::is_same_v<Pool, Ts>, index += found ? 0 : 1), ...);
+
+        return index;
+    }
+
+    template<typename... Ts>
+    const std::vector<EntityHandle>& smallest() {
+        const std::vector<EntityHandle>* result = nullptr;
+        ((result = (!result || storage<Ts>().size() < result->size()) ? &storage<Ts>().entities() : result), ...);
+
+        return *result;
+    }
+
+    Pools pools;
+
+    std::vector<std::uint32_t> generations;
+    std::vector<EntityId> ids;
+    std::vector<EntityIndex> free_indices;
+    std::size_t live_count = 0;
+    mutable std::unordered_map<EntityId, EntityHandle> handle_by_id; // Only kept up to date while `is_indexed`.
+    mutable bool is_indexed = true;
+};
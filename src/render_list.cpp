@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cassert>
+#include "render_list.h"
+
+
+static bool entry_less(const RenderList::Entry& a, const RenderList::Entry& b) {
+    return a.key < b.key;
+}
+
+void RenderList::update(EntityHandle entity, Key key) {
+    if (entity.index() >= states.size()) {
+        states.resize(entity.index() + 1, State::Absent);
+        keys.resize(entity.index() + 1);
+        pending_positions.resize(entity.index() + 1, 0);
+    }
+
+    State& state = states[entity.index()];
+
+    if (state == State::Pending) {
+        pending_entries[pending_positions[entity.index()]].key = key;
+        keys[entity.index()] = key;
+
+        return;
+    }
+
+    if (state == State::Sorted) {
+        if (keys[entity.index()] == key) {
+            return;
+        }
+
+        // The old entry stays where it is until the merge drops it.
+        ++stale_count;
+    }
+
+    pending_positions[entity.index()] = (std::uint32_t) pending_entries.size();
+    pending_entries.push_back(Entry{key, entity});
+    keys[entity.index()] = key;
+    state = State::Pending;
+}
+
+void RenderList::remove(EntityHandle entity) {
+    if (entity.index() >= states.size()) {
+        return;
+    }
+
+    State& state = states[entity.index()];
+
+    if (state == State::Sorted) {
+        ++stale_count;
+    } else if (state == State::Pending) {
+        // An entity that was sorted before is already counted as stale.
+        pending_entries[pending_positions[entity.index()]].entity = NULL_ENTITY;
+    }
+
+    state = State::Absent;
+}
+
+void RenderList::reserve(std::size_t count) {
+    pending_entries.reserve(pending_entries.size() + count);
+}
+
+void RenderList::merge_pending() const {
+    auto is_stale = [this](const Entry& entry) {
+        return entry.entity == NULL_ENTITY || states[entry.entity.index()] != State::Sorted;
+    };
+
+    if (stale_count > 0) {
+        sorted_entries.erase(std::remove_if(sorted_entries.begin(), sorted_entries.end(), is_stale), sorted_entries.end());
+    }
+
+    pending_entries.erase(std::remove_if(pending_entries.begin(), pending_entries.end(), [](const Entry& entry) {
+        return entry.entity == NULL_ENTITY;
+    }), pending_entries.end());
+
+    // Stable on both sides, and std::merge takes from the sorted side first on equal keys, so what changed draws
+    // above what it is equal to, in the order it changed.
+    std::stable_sort(pending_entries.begin(), pending_entries.end(), entry_less);
+
+    merge_buffer.resize(sorted_entries.size() + pending_entries.size());
+    std::merge(sorted_entries.begin(), sorted_entries.end(), pending_entries.begin(), pending_entries.end(), merge_buffer.begin(), entry_less);
+    sorted_entries.swap(merge_buffer);
+
+    for (const Entry& entry: pending_entries) {
+        states[entry.entity.index()] = State::Sorted;
+    }
+
+    pending_entries.clear();
+    stale_count = 0;
+}
+
+void RenderList::assign(std::vector<Entry> entries_) {
+    clear();
+    sorted_entries = std::move(entries_);
+
+    // Saved lists are in draw order, not by index, so the per entity arrays are sized once up front.
+    std::size_t slot_count = 0;
+
+    for (const Entry& entry: sorted_entries) {
+        slot_count = std::max<std::size_t>(slot_count, entry.entity.index() + 1);
+    }
+
+    states.resize(slot_count, State::Absent);
+    keys.resize(slot_count);
+    pending_positions.resize(slot_count, 0);
+
+    for (const Entry& entry: sorted_entries) {
+        keys[entry.entity.index()] = entry.key;
+        states[entry.entity.index()] = State::Sorted;
+    }
+
+    assert(std::is_sorted(sorted_entries.begin(), sorted_entries.end(), entry_less));
+}
+
+void RenderList::clear() {
+    sorted_entries.clear();
+    pending_entries.clear();
+    stale_count = 0;
+    states.clear();
+    keys.clear();
+    pending_positions.clear();
+}
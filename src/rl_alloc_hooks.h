@@ -0,0 +1,22 @@
+#pragma once
+
+// Force included into raylib's C sources when CARD_GAME_ALLOC_TRACKING is on, RL_MALLOC and friends are defined
+// to these so raylib's own allocations are attributed like everything else. Defined in allocation_counter.cpp.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* card_game_rl_malloc(size_t size);
+
+void* card_game_rl_calloc(size_t count, size_t size);
+
+void* card_game_rl_realloc(void* memory, size_t size);
+
+void card_game_rl_free(void* memory);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdio>
+#include "profiler.h"
+#include "scheduler.h"
+
+
+void Scheduler::add(const char* name, int priority, SystemAccess access, System run) {
+    entries.push_back(Entry{name, priority, access, std::move(run)});
+    is_built = false;
+}
+
+void Scheduler::build() {
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.priority < b.priority;
+    });
+
+    stage_systems.clear();
+    ambiguous.clear();
+
+    // A system goes one stage after the latest earlier system it conflicts with.
+    std::vector<std::size_t> stage_of(entries.size(), 0);
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        for (std::size_t j = 0; j < i; ++j) {
+            if (!entries[i].access.conflicts_with(entries[j].access)) {
+                continue;
+            }
+
+            stage_of[i] = std::max(stage_of[i], stage_of[j] + 1);
+
+            if (entries[i].priority == entries[j].priority) {
+                printf("Unable to order %s and %s by priority, they conflict so %s runs first as it was added first.\n",
+                       entries[j].name, entries[i].name, entries[j].name);
+                ambiguous.emplace_back(j, i);
+            }
+        }
+
+        if (stage_of[i] >= stage_systems.size()) {
+            stage_systems.resize(stage_of[i] + 1);
+        }
+
+        stage_systems[stage_of[i]].push_back(i);
+    }
+
+    is_built = true;
+}
+
+void Scheduler::run(JobSystem* job_system) {
+    if (!is_built) {
+        build();
+    }
+
+    if (!job_system || job_system->worker_count() == 0) {
+        for (const Entry& entry: entries) {
+            PROFILE_SCOPE(entry.name);
+            entry.run();
+        }
+
+        return;
+    }
+
+    auto run_system = [](void* context, std::size_t, std::size_t) {
+        const Entry& entry = *static_cast<const Entry*>(context);
+        PROFILE_SCOPE(entry.name);
+        entry.run();
+    };
+
+    // The first system of a stage runs here, the rest go to the workers.
+    for (const std::vector<std::size_t>& stage: stage_systems) {
+        JobCounter counter;
+
+        for (std::size_t i = 1; i < stage.size(); ++i) {
+            job_system->submit(counter, Job{run_system, (void*) &entries[stage[i]]});
+        }
+
+        run_system((void*) &entries[stage.front()], 0, 0);
+        job_system->wait(counter);
+    }
+}
+
+void Scheduler::clear() {
+    entries.clear();
+    stage_systems.clear();
+    ambiguous.clear();
+    is_built = true;
+}
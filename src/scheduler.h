@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "job_system.h"
+#include "registry.h"
+
+
+// One bit per component pool, followed by the table wide structures systems share.
+using AccessMask = std::uint32_t;
+
+enum class Resource : std::uint8_t {
+    SpatialGrid,
+    GridUpdates,
+    RenderList,
+    Commands,
+};
+
+template<typename T>
+constexpr AccessMask component_bit() {
+    return AccessMask{1} << Registry::component_index<T>();
+}
+
+constexpr AccessMask resource_bit(Resource resource) {
+    return AccessMask{1} << (Registry::COMPONENT_COUNT + (std::size_t) resource);
+}
+
+// What a system reads and writes. Two systems conflict when either one writes something the other touches.
+struct SystemAccess {
+    AccessMask reads = 0;
+    AccessMask writes = 0;
+
+    template<typename... Ts>
+    SystemAccess& read() {
+        reads |= (component_bit<Ts>() | ... | 0);
+        return *this;
+    }
+
+    template<typename... Ts>
+    SystemAccess& write() {
+        writes |= (component_bit<Ts>() | ... | 0);
+        return *this;
+    }
+
+    SystemAccess& read(Resource resource) {
+        reads |= resource_bit(resource);
+        return *this;
+    }
+
+    SystemAccess& write(Resource resource) {
+        writes |= resource_bit(resource);
+        return *this;
+    }
+
+    [[nodiscard]] bool conflicts_with(const SystemAccess& other) const {
+        return (writes & (other.reads | other.writes)) != 0 || (other.writes & reads) != 0;
+    }
+};
+
+// Runs systems by priority, lower first and ties in the order they were added. From the declared access it also
+// groups them into stages: every system only conflicts with systems of earlier stages, so the systems of one stage
+// can run at the same time, which they do when run on a job system with workers. Each system runs in its own profiler
+// scope.
+class Scheduler {
+public:
+    using System = std::function<void()>;
+
+    struct Entry {
+        const char* name; // Also the profiler scope name, must outlive the scheduler.
+        int priority;
+        SystemAccess access;
+        System run;
+    };
+
+    void add(const char* name, int priority, SystemAccess access, System run);
+
+    // Sorts and builds the stages, done by `run` as well when systems were added since.
+    void build();
+
+    // Without a job system, or one without workers, systems run one after another on the calling thread.
+    void run(JobSystem* job_system = nullptr);
+
+    [[nodiscard]] const std::vector<Entry>& systems() const {
+        return entries;
+    }
+
+    // Indices into `systems()`.
+    [[nodiscard]] const std::vector<std::vector<std::size_t>>& stages() const {
+        return stage_systems;
+    }
+
+    // Pairs of systems that conflict at the same priority, only the order they were added in decides between them.
+    [[nodiscard]] const std::vector<std::pair<std::size_t, std::size_t>>& ambiguities() const {
+        return ambiguous;
+    }
+
+    void clear();
+
+private:
+    std::vector<Entry> entries;
+    std::vector<std::vector<std::size_t>> stage_systems;
+    std::vector<std::pair<std::size_t, std::size_t>> ambiguous;
+    bool is_built = true;
+};
@@ -0,0 +1,274 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "snapshot.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+constexpr const std::size_t SNAPSHOT_SECTION_ALIGNMENT = 8;
+
+// Appends a section at the next aligned offset and returns that offset.
+template<typename Section>
+static std::uint64_t append_section(std::vector<unsigned char>& file_data, const Section& section) {
+    std::span bytes = std::as_bytes(std::span{section});
+    std::size_t offset = (file_data.size() + SNAPSHOT_SECTION_ALIGNMENT - 1) / SNAPSHOT_SECTION_ALIGNMENT * SNAPSHOT_SECTION_ALIGNMENT;
+    file_data.resize(offset + bytes.size());
+
+    if (!bytes.empty()) {
+        std::memcpy(file_data.data() + offset, bytes.data(), bytes.size());
+    }
+
+    return offset;
+}
+
+void encode_snapshot_file(const SnapshotData& snapshot_data, std::vector<unsigned char>& file_data) {
+    file_data.assign(sizeof(SnapshotHeader), 0);
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.tick = snapshot_data.tick;
+    header.seed = snapshot_data.seed;
+    header.left_clicked = snapshot_data.left_clicked ? 1 : 0;
+
+    header.slots_offset = append_section(file_data, snapshot_data.slots);
+    header.free_offset = append_section(file_data, snapshot_data.free_indices);
+    header.transforms_offset = append_section(file_data, snapshot_data.transforms);
+    header.renders_offset = append_section(file_data, snapshot_data.renders);
+    header.draggables_offset = append_section(file_data, snapshot_data.draggables);
+    header.stackables_offset = append_section(file_data, snapshot_data.stackables);
+    header.stacks_offset = append_section(file_data, snapshot_data.stacks);
+    header.members_offset = append_section(file_data, snapshot_data.members);
+    header.draw_order_offset = append_section(file_data, snapshot_data.draw_order);
+    header.grid_cells_offset = append_section(file_data, snapshot_data.grid_cells);
+    header.grid_entities_offset = append_section(file_data, snapshot_data.grid_entities);
+    header.sprites_offset = append_section(file_data, snapshot_data.sprites);
+    header.rng_state_offset = append_section(file_data, snapshot_data.rng_state);
+
+    header.slot_count = (std::uint32_t) snapshot_data.slots.size();
+    header.free_count = (std::uint32_t) snapshot_data.free_indices.size();
+    header.transform_count = (std::uint32_t) snapshot_data.transforms.size();
+    header.render_count = (std::uint32_t) snapshot_data.renders.size();
+    header.draggable_count = (std::uint32_t) snapshot_data.draggables.size();
+    header.stackable_count = (std::uint32_t) snapshot_data.stackables.size();
+    header.stack_count = (std::uint32_t) snapshot_data.stacks.size();
+    header.member_count = (std::uint32_t) snapshot_data.members.size();
+    header.draw_order_count = (std::uint32_t) snapshot_data.draw_order.size();
+    header.grid_cell_count = (std::uint32_t) snapshot_data.grid_cells.size();
+    header.grid_entity_count = (std::uint32_t) snapshot_data.grid_entities.size();
+    header.sprite_count = (std::uint32_t) snapshot_data.sprites.size();
+    header.rng_state_size = (std::uint32_t) snapshot_data.rng_state.size();
+    header.file_size = file_data.size();
+
+    std::memcpy(file_data.data(), &header, sizeof(header));
+}
+
+bool sync_file(FILE* file) {
+    if (fflush(file) != 0) {
+        return false;
+    }
+
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool write_snapshot_file(const char* file_name, std::span<const unsigned char> file_data) {
+    std::string temp_file_name = std::string{file_name} + ".tmp";
+    FILE* file = fopen(temp_file_name.c_str(), "wb");
+
+    if (!file) {
+        printf("Unable to open %s for writing.\n", temp_file_name.c_str());
+
+        return false;
+    }
+
+    bool written = fwrite(file_data.data(), 1, file_data.size(), file) == file_data.size() && sync_file(file);
+    fclose(file);
+
+    std::error_code error;
+
+    if (written) {
+        std::filesystem::rename(temp_file_name, file_name, error);
+    }
+
+    if (!written || error) {
+        printf("Unable to write the snapshot to %s.\n", file_name);
+
+        return false;
+    }
+
+    return true;
+}
+
+Snapshot::~Snapshot() {
+    close();
+}
+
+bool Snapshot::open(const char* file_name) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER file_size{};
+
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        printf("Unable to open %s for reading.\n", file_name);
+
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+    if (!view) {
+        printf("Unable to map %s.\n", file_name);
+
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+
+        CloseHandle(file);
+
+        return false;
+    }
+
+    file_handle = file;
+    mapping_handle = mapping;
+    data = static_cast<const unsigned char*>(view);
+    size = (std::size_t) file_size.QuadPart;
+    is_mapped = true;
+#else
+    int file = ::open(file_name, O_RDONLY);
+    struct stat file_stat{};
+
+    if (file < 0 || fstat(file, &file_stat) != 0 || file_stat.st_size == 0) {
+        printf("Unable to open %s for reading.\n", file_name);
+
+        if (file >= 0) {
+            ::close(file);
+        }
+
+        return false;
+    }
+
+    void* view = mmap(nullptr, (std::size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps the file alive on its own.
+    ::close(file);
+
+    if (view == MAP_FAILED) {
+        printf("Unable to map %s.\n", file_name);
+
+        return false;
+    }
+
+    data = static_cast<const unsigned char*>(view);
+    size = (std::size_t) file_stat.st_size;
+    is_mapped = true;
+#endif
+
+    if (!is_valid()) {
+        printf("Unable to read %s as it is not a snapshot.\n", file_name);
+        close();
+
+        return false;
+    }
+
+    return true;
+}
+
+bool Snapshot::open(std::span<const unsigned char> file_data) {
+    close();
+
+    // Sections are read in place, they have to be as aligned as they would be in a mapping.
+    if (file_data.empty() || (std::uintptr_t) file_data.data() % SNAPSHOT_SECTION_ALIGNMENT != 0) {
+        printf("Unable to read a snapshot that is empty or not aligned.\n");
+
+        return false;
+    }
+
+    data = file_data.data();
+    size = file_data.size();
+
+    if (!is_valid()) {
+        printf("Unable to read the snapshot as it is not one.\n");
+        close();
+
+        return false;
+    }
+
+    return true;
+}
+
+void Snapshot::close() {
+    if (!data) {
+        return;
+    }
+
+    if (is_mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        mapping_handle = nullptr;
+        file_handle = nullptr;
+#else
+        munmap(const_cast<unsigned char*>(data), size);
+#endif
+    }
+
+    data = nullptr;
+    size = 0;
+    is_mapped = false;
+}
+
+static bool section_fits(std::uint64_t offset, std::uint64_t count, std::size_t element_size, std::size_t file_size) {
+    return offset % SNAPSHOT_SECTION_ALIGNMENT == 0 && offset <= file_size && count <= (file_size - offset) / element_size;
+}
+
+bool Snapshot::is_valid() const {
+    if (size < sizeof(SnapshotHeader)) {
+        return false;
+    }
+
+    const SnapshotHeader& snapshot_header = header();
+
+    if (std::memcmp(snapshot_header.magic, SNAPSHOT_MAGIC, sizeof(snapshot_header.magic)) != 0 ||
+        snapshot_header.version != SNAPSHOT_VERSION || snapshot_header.file_size != size) {
+        return false;
+    }
+
+    return section_fits(snapshot_header.slots_offset, snapshot_header.slot_count, sizeof(SnapshotSlot), size) &&
+           section_fits(snapshot_header.free_offset, snapshot_header.free_count, sizeof(std::uint32_t), size) &&
+           section_fits(snapshot_header.transforms_offset, snapshot_header.transform_count, sizeof(SnapshotTransform), size) &&
+           section_fits(snapshot_header.renders_offset, snapshot_header.render_count, sizeof(SnapshotRender), size) &&
+           section_fits(snapshot_header.draggables_offset, snapshot_header.draggable_count, sizeof(SnapshotDraggable), size) &&
+           section_fits(snapshot_header.stackables_offset, snapshot_header.stackable_count, sizeof(std::uint32_t), size) &&
+           section_fits(snapshot_header.stacks_offset, snapshot_header.stack_count, sizeof(SnapshotStack), size) &&
+           section_fits(snapshot_header.members_offset, snapshot_header.member_count, sizeof(std::uint32_t), size) &&
+           section_fits(snapshot_header.draw_order_offset, snapshot_header.draw_order_count, sizeof(std::uint32_t), size) &&
+           section_fits(snapshot_header.grid_cells_offset, snapshot_header.grid_cell_count, sizeof(std::uint32_t), size) &&
+           section_fits(snapshot_header.grid_entities_offset, snapshot_header.grid_entity_count, sizeof(std::uint32_t), size) &&
+           section_fits(snapshot_header.sprites_offset, snapshot_header.sprite_count, sizeof(SnapshotSprite), size) &&
+           section_fits(snapshot_header.rng_state_offset, snapshot_header.rng_state_size, 1, size);
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// Snapshot file layout, native little endian, every section starting 8 byte aligned at the offset the header gives:
+//   SnapshotHeader
+//   SnapshotSlot[slot_count]                  registry slots by entity index, dead ones have a nil uuid
+//   std::uint32_t[free_count]                 registry free list
+//   SnapshotTransform[transform_count]        each pool in its dense order, so a loaded table iterates the same
+//   SnapshotRender[render_count]
+//   SnapshotDraggable[draggable_count]
+//   std::uint32_t[stackable_count]            entities that are stackable
+//   SnapshotStack[stack_count]
+//   std::uint32_t[member_count]               stack members, indexed by SnapshotStack::members_begin
+//   std::uint32_t[draw_order_count]           entities in the order the render list draws them
+//   std::uint32_t[grid_cell_count]            entities per spatial grid cell
+//   std::uint32_t[grid_entity_count]          spatial grid cell contents, cell after cell in query order
+//   SnapshotSprite[sprite_count]              sprite names, indexed by SnapshotRender::sprite
+//   char[rng_state_size]                      the table's std::mt19937 as its stream text
+// Entities are stored by raw EntityHandle. Everything is fixed size, so the sections are read straight from the mapping.
+// Loading a table still copies them into its pools, whose components hold more than is saved, and rebuilds the grid.
+constexpr const char SNAPSHOT_MAGIC[4] = {'C', 'G', 'S', 'N'};
+constexpr const std::uint32_t SNAPSHOT_VERSION = 2;
+constexpr const std::uint32_t SNAPSHOT_NULL_SPRITE = 0xFFFFFFFF;
+
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t tick;
+    std::uint32_t seed;
+    std::uint32_t left_clicked;
+    std::uint64_t file_size;
+    std::uint64_t slots_offset;
+    std::uint64_t free_offset;
+    std::uint64_t transforms_offset;
+    std::uint64_t renders_offset;
+    std::uint64_t draggables_offset;
+    std::uint64_t stackables_offset;
+    std::uint64_t stacks_offset;
+    std::uint64_t members_offset;
+    std::uint64_t draw_order_offset;
+    std::uint64_t grid_cells_offset;
+    std::uint64_t grid_entities_offset;
+    std::uint64_t sprites_offset;
+    std::uint64_t rng_state_offset;
+    std::uint32_t slot_count;
+    std::uint32_t free_count;
+    std::uint32_t transform_count;
+    std::uint32_t render_count;
+    std::uint32_t draggable_count;
+    std::uint32_t stackable_count;
+    std::uint32_t stack_count;
+    std::uint32_t member_count;
+    std::uint32_t draw_order_count;
+    std::uint32_t grid_cell_count;
+    std::uint32_t grid_entity_count;
+    std::uint32_t sprite_count;
+    std::uint32_t rng_state_size;
+    std::uint32_t padding;
+};
+
+struct SnapshotSlot {
+    std::uint8_t id[16];
+    std::uint32_t generation;
+    std::uint32_t padding;
+};
+
+struct SnapshotTransform {
+    std::uint32_t entity;
+    std::uint32_t stack_root;
+    std::uint32_t stack_index;
+    float rec[4];
+    float last_rec[4];
+    float screen_rec[4];
+};
+
+struct SnapshotRender {
+    std::uint32_t entity;
+    std::uint32_t sprite;
+    float offset_x;
+    float offset_y;
+    std::uint32_t face_up;
+};
+
+struct SnapshotDraggable {
+    std::uint32_t entity;
+    std::uint32_t is_selected;
+};
+
+struct SnapshotStack {
+    std::uint32_t entity;
+    std::uint32_t members_begin;
+    std::uint32_t members_count;
+};
+
+struct SnapshotSprite {
+    char name[48];
+};
+
+static_assert(sizeof(SnapshotHeader) == 192);
+static_assert(sizeof(SnapshotSlot) == 24);
+static_assert(sizeof(SnapshotTransform) == 60);
+static_assert(sizeof(SnapshotRender) == 20);
+static_assert(sizeof(SnapshotDraggable) == 8);
+static_assert(sizeof(SnapshotStack) == 12);
+static_assert(sizeof(SnapshotSprite) == 48);
+
+// The sections of a snapshot about to be written. Filling the same one again reuses its storage.
+struct SnapshotData {
+    std::uint64_t tick = 0;
+    std::uint32_t seed = 0;
+    bool left_clicked = false;
+    std::vector<SnapshotSlot> slots;
+    std::vector<std::uint32_t> free_indices;
+    std::vector<SnapshotTransform> transforms;
+    std::vector<SnapshotRender> renders;
+    std::vector<SnapshotDraggable> draggables;
+    std::vector<std::uint32_t> stackables;
+    std::vector<SnapshotStack> stacks;
+    std::vector<std::uint32_t> members;
+    std::vector<std::uint32_t> draw_order;
+    std::vector<std::uint32_t> grid_cells;
+    std::vector<std::uint32_t> grid_entities;
+    std::vector<SnapshotSprite> sprites;
+    std::string rng_state;
+};
+
+// Lays the sections out behind a header, replacing what `file_data` held.
+void encode_snapshot_file(const SnapshotData& snapshot_data, std::vector<unsigned char>& file_data);
+
+// Pushes what was written to the file through to the disk.
+bool sync_file(FILE* file);
+
+// Writes an encoded snapshot next to `file_name` and renames it over the old one once synced, so a crash leaves either
+// the old snapshot or the new one.
+bool write_snapshot_file(const char* file_name, std::span<const unsigned char> file_data);
+
+// Read-only mapping of a snapshot file. The sections are views straight into the mapping, nothing is parsed or
+// copied until a table loads from it.
+class Snapshot {
+public:
+    Snapshot() = default;
+
+    ~Snapshot();
+
+    Snapshot(const Snapshot&) = delete;
+
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    // Maps the file and checks the header and that every section is inside it.
+    bool open(const char* file_name);
+
+    // Same checks over a snapshot already in memory, e.g. an encoded one. `file_data` has to stay alive and unchanged
+    // while the snapshot is open.
+    bool open(std::span<const unsigned char> file_data);
+
+    void close();
+
+    // The whole file as mapped.
+    [[nodiscard]] std::span<const unsigned char> bytes() const {
+        return std::span<const unsigned char>{data, size};
+    }
+
+    [[nodiscard]] const SnapshotHeader& header() const {
+        return *reinterpret_cast<const SnapshotHeader*>(data);
+    }
+
+    [[nodiscard]] std::span<const SnapshotSlot> slots() const {
+        return section<SnapshotSlot>(header().slots_offset, header().slot_count);
+    }
+
+    [[nodiscard]] std::span<const std::uint32_t> free_indices() const {
+        return section<std::uint32_t>(header().free_offset, header().free_count);
+    }
+
+    [[nodiscard]] std::span<const SnapshotTransform> transforms() const {
+        return section<SnapshotTransform>(header().transforms_offset, header().transform_count);
+    }
+
+    [[nodiscard]] std::span<const SnapshotRender> renders() const {
+        return section<SnapshotRender>(header().renders_offset, header().render_count);
+    }
+
+    [[nodiscard]] std::span<const SnapshotDraggable> draggables() const {
+        return section<SnapshotDraggable>(header().draggables_offset, header().draggable_count);
+    }
+
+    [[nodiscard]] std::span<const std::uint32_t> stackables() const {
+        return section<std::uint32_t>(header().stackables_offset, header().stackable_count);
+    }
+
+    [[nodiscard]] std::span<const SnapshotStack> stacks() const {
+        return section<SnapshotStack>(header().stacks_offset, header().stack_count);
+    }
+
+    [[nodiscard]] std::span<const std::uint32_t> members() const {
+        return section<std::uint32_t>(header().members_offset, header().member_count);
+    }
+
+    [[nodiscard]] std::span<const std::uint32_t> draw_order() const {
+        return section<std::uint32_t>(header().draw_order_offset, header().draw_order_count);
+    }
+
+    [[nodiscard]] std::span<const std::uint32_t> grid_cells() const {
+        return section<std::uint32_t>(header().grid_cells_offset, header().grid_cell_count);
+    }
+
+    [[nodiscard]] std::span<const std::uint32_t> grid_entities() const {
+        return section<std::uint32_t>(header().grid_entities_offset, header().grid_entity_count);
+    }
+
+    [[nodiscard]] std::span<const SnapshotSprite> sprites() const {
+        return section<SnapshotSprite>(header().sprites_offset, header().sprite_count);
+    }
+
+    [[nodiscard]] std::string_view rng_state() const {
+        return std::string_view{reinterpret_cast<const char*>(data + header().rng_state_offset), header().rng_state_size};
+    }
+
+private:
+    template<typename T>
+    [[nodiscard]] std::span<const T> section(std::uint64_t offset, std::uint32_t count) const {
+        return std::span<const T>{reinterpret_cast<const T*>(data + offset), count};
+    }
+
+    [[nodiscard]] bool is_valid() const;
+
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+    bool is_mapped = false;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+};
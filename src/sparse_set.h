@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include "entity.h"
+
+
+// Dense storage of one component type. `sparse` maps an entity index to a slot in `dense`/`data`,
+// so iteration only touches entities that actually own the component and lookup is two array reads.
+// `dense` keeps the full handle, which makes a stale handle fail `contains` without touching the registry.
+template<typename T>
+class SparseSet {
+public:
+    template<typename... Args>
+    T& emplace(EntityHandle entity, Args&& ... args) {
+        assert(!contains(entity));
+
+        if (entity.index() >= sparse.size()) {
+            sparse.resize(entity.index() + 1, NPOS);
+        }
+
+        sparse[entity.index()] = static_cast<std::uint32_t>(dense.size());
+        dense.push_back(entity);
+
+        return data.emplace_back(std::forward<Args>(args)...);
+    }
+
+    // Swap-and-pop, so removing invalidates the dense order. Don't remove while iterating this set.
+    void remove(EntityHandle entity) {
+        if (!contains(entity)) {
+            return;
+        }
+
+        std::uint32_t slot = sparse[entity.index()];
+        EntityHandle last_entity = dense.back();
+
+        dense[slot] = last_entity;
+        data[slot] = std::move(data.back());
+        sparse[last_entity.index()] = slot;
+
+        dense.pop_back();
+        data.pop_back();
+        sparse[entity.index()] = NPOS;
+    }
+
+    [[nodiscard]] bool contains(EntityHandle entity) const {
+        return entity.index() < sparse.size() && sparse[entity.index()] != NPOS && dense[sparse[entity.index()]] == entity;
+    }
+
+    T& get(EntityHandle entity) {
+        assert(contains(entity));
+
+        return data[sparse[entity.index()]];
+    }
+
+    const T& get(EntityHandle entity) const {
+        assert(contains(entity));
+
+        return data[sparse[entity.index()]];
+    }
+
+    T* try_get(EntityHandle entity) {
+        return contains(entity) ? &data[sparse[entity.index()]] : nullptr;
+    }
+
+    const T* try_get(EntityHandle entity) const {
+        return contains(entity) ? &data[sparse[entity.index()]] : nullptr;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return dense.size();
+    }
+
+    void reserve(std::size_t count) {
+        dense.reserve(count);
+        data.reserve(count);
+    }
+
+    [[nodiscard]] const std::vector<EntityHandle>& entities() const {
+        return dense;
+    }
+
+    std::vector<T>& components() {
+        return data;
+    }
+
+    const std::vector<T>& components() const {
+        return data;
+    }
+
+    void clear() {
+        sparse.clear();
+        dense.clear();
+        data.clear();
+    }
+
+private:
+    static constexpr std::uint32_t NPOS = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<std::uint32_t> sparse;
+    std::vector<EntityHandle> dense;
+    std::vector<T> data;
+};
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cmath>
+#include "spatial_grid.h"
+
+
+SpatialGrid::SpatialGrid(Rectangle bounds_, float cell_size_) :
+        bounds{bounds_},
+        cell_size{cell_size_},
+        columns{std::max(1, (int) std::ceil(bounds_.width / cell_size_))},
+        rows{std::max(1, (int) std::ceil(bounds_.height / cell_size_))},
+        cells((std::size_t) (columns * rows)) {
+
+}
+
+int SpatialGrid::cell_coord(float value, float origin, int count) const {
+    return std::clamp((int) std::floor((value - origin) / cell_size), 0, count - 1);
+}
+
+SpatialGrid::CellRange SpatialGrid::cell_range(Rectangle rec) const {
+    return CellRange{
+            cell_coord(rec.x, bounds.x, columns),
+            cell_coord(rec.y, bounds.y, rows),
+            cell_coord(rec.x + rec.width, bounds.x, columns),
+            cell_coord(rec.y + rec.height, bounds.y, rows)
+    };
+}
+
+void SpatialGrid::add_to_cells(EntityHandle entity, CellRange range) {
+    for (int y = range.min_y; y <= range.max_y; ++y) {
+        for (int x = range.min_x; x <= range.max_x; ++x) {
+            cells[(std::size_t) (y * columns + x)].push_back(entity);
+        }
+    }
+}
+
+void SpatialGrid::remove_from_cells(EntityHandle entity, CellRange range) {
+    for (int y = range.min_y; y <= range.max_y; ++y) {
+        for (int x = range.min_x; x <= range.max_x; ++x) {
+            std::vector<EntityHandle>& cell = cells[(std::size_t) (y * columns + x)];
+            auto it = std::find(cell.begin(), cell.end(), entity);
+
+            if (it != cell.end()) {
+                *it = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+}
+
+void SpatialGrid::update(EntityHandle entity, Rectangle rec) {
+    if (entity.index() >= ranges.size()) {
+        ranges.resize(entity.index() + 1);
+    }
+
+    CellRange range = cell_range(rec);
+    CellRange& current = ranges[entity.index()];
+
+    if (current == range) {
+        return;
+    }
+
+    if (current.min_x >= 0) {
+        remove_from_cells(entity, current);
+    }
+
+    add_to_cells(entity, range);
+    current = range;
+}
+
+void SpatialGrid::remove(EntityHandle entity) {
+    if (entity.index() >= ranges.size() || ranges[entity.index()].min_x < 0) {
+        return;
+    }
+
+    remove_from_cells(entity, ranges[entity.index()]);
+    ranges[entity.index()] = CellRange{};
+}
+
+void SpatialGrid::clear() {
+    for (std::vector<EntityHandle>& cell: cells) {
+        cell.clear();
+    }
+
+    ranges.clear();
+}
+
+void SpatialGrid::query(Rectangle area, std::pmr::vector<EntityHandle>& result) const {
+    CellRange range = cell_range(area);
+
+    for (int y = range.min_y; y <= range.max_y; ++y) {
+        for (int x = range.min_x; x <= range.max_x; ++x) {
+            for (EntityHandle entity: cells[(std::size_t) (y * columns + x)]) {
+                const CellRange& cells_of = ranges[entity.index()];
+
+                // An entity spanning several cells is only taken from the first of them the query walks over.
+                if (x == std::max(cells_of.min_x, range.min_x) && y == std::max(cells_of.min_y, range.min_y)) {
+                    result.push_back(entity);
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::reserve_cell(std::size_t index, std::size_t count) {
+    if (index < cells.size()) {
+        cells[index].reserve(count);
+    }
+}
+
+bool SpatialGrid::restore_cell_order(std::size_t index, std::span<const EntityHandle> entities) {
+    if (index >= cells.size() || entities.size() != cells[index].size()) {
+        return false;
+    }
+
+    int x = (int) (index % (std::size_t) columns);
+    int y = (int) (index / (std::size_t) columns);
+
+    for (EntityHandle entity: entities) {
+        if (entity.index() >= ranges.size()) {
+            return false;
+        }
+
+        const CellRange& range = ranges[entity.index()];
+
+        if (x < range.min_x || x > range.max_x || y < range.min_y || y > range.max_y) {
+            return false;
+        }
+    }
+
+    cells[index].assign(entities.begin(), entities.end());
+
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+#include <raylib.h>
+#include "entity.h"
+
+
+// Uniform grid broadphase over the table. Entities are bucketed by the cells their screen rec overlaps,
+// anything outside of `bounds` is clamped into the border cells so it is still found, just less selectively.
+class SpatialGrid {
+public:
+    SpatialGrid(Rectangle bounds_, float cell_size_);
+
+    // Inserts the entity if it is not in the grid yet. Moving within the same cells costs a compare.
+    void update(EntityHandle entity, Rectangle rec);
+
+    void remove(EntityHandle entity);
+
+    void clear();
+
+    // Appends each entity whose cells overlap `area` once. These are candidates, callers still do the exact test.
+    // Only reads the grid, so any number of queries may run at the same time as long as nothing updates it.
+    void query(Rectangle area, std::pmr::vector<EntityHandle>& result) const;
+
+    // Cell contents in the order queries return them, for saving the grid.
+    [[nodiscard]] const std::vector<std::vector<EntityHandle>>& get_cells() const {
+        return cells;
+    }
+
+    // Makes room for `count` entities in a cell, before filling a grid whose cell sizes are known.
+    void reserve_cell(std::size_t index, std::size_t count);
+
+    // Puts a cell's entities back in a saved order, so queries return them as they did before saving. Leaves the cell
+    // as it is and returns false unless `entities` are the ones the cell holds.
+    bool restore_cell_order(std::size_t index, std::span<const EntityHandle> entities);
+
+private:
+    struct CellRange {
+        int min_x = -1;
+        int min_y = -1;
+        int max_x = -1;
+        int max_y = -1;
+
+        bool operator==(const CellRange&) const = default;
+    };
+
+    [[nodiscard]] CellRange cell_range(Rectangle rec) const;
+
+    [[nodiscard]] int cell_coord(float value, float origin, int count) const;
+
+    void add_to_cells(EntityHandle entity, CellRange range);
+
+    void remove_from_cells(EntityHandle entity, CellRange range);
+
+    Rectangle bounds;
+    float cell_size;
+    int columns;
+    int rows;
+    std::vector<std::vector<EntityHandle>> cells;
+    std::vector<CellRange> ranges; // Indexed by entity index, min_x == -1 when not in the grid.
+};
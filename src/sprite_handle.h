@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+
+using SpriteHandle = std::uint32_t;
+
+constexpr const SpriteHandle NULL_SPRITE = std::numeric_limits<SpriteHandle>::max();
@@ -0,0 +1,39 @@
+#include "sprite_table.h"
+
+
+SpriteHandle SpriteTable::find_or_add(std::string_view name) {
+    auto it = by_name.find(name);
+
+    if (it != by_name.end()) {
+        return it->second;
+    }
+
+    SpriteHandle sprite = (SpriteHandle) sprites.size();
+    sprites.emplace_back();
+    names.emplace_back(name);
+    by_name.emplace(name, sprite);
+
+    return sprite;
+}
+
+void SpriteTable::assign(TextureCache& texture_cache, std::string_view name, TextureHandle texture, Rectangle source) {
+    Sprite& sprite = sprites[find_or_add(name)];
+
+    if (texture != NULL_TEXTURE) {
+        texture_cache.retain(texture);
+    }
+
+    texture_cache.release(sprite.texture);
+    sprite.texture = texture;
+    sprite.source = source;
+}
+
+void SpriteTable::clear(TextureCache& texture_cache) {
+    for (const Sprite& sprite: sprites) {
+        texture_cache.release(sprite.texture);
+    }
+
+    sprites.clear();
+    names.clear();
+    by_name.clear();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <raylib.h>
+#include "sprite_handle.h"
+#include "texture_cache.h"
+
+
+struct Sprite {
+    TextureHandle texture = NULL_TEXTURE; // NULL_TEXTURE while the image is still streaming in.
+    Rectangle source{};
+};
+
+// Named sprites that entities reference by handle. A sprite can be handed out before its image is loaded and
+// re-pointed later, which is how streamed textures and alternate skins reach every card showing that sprite.
+// Holds one texture reference per assigned sprite.
+class SpriteTable {
+public:
+    SpriteHandle find_or_add(std::string_view name);
+
+    void assign(TextureCache& texture_cache, std::string_view name, TextureHandle texture, Rectangle source);
+
+    [[nodiscard]] const Sprite& get(SpriteHandle sprite) const {
+        return sprites[sprite];
+    }
+
+    [[nodiscard]] bool is_ready(SpriteHandle sprite) const {
+        return sprites[sprite].texture != NULL_TEXTURE;
+    }
+
+    [[nodiscard]] std::string_view name(SpriteHandle sprite) const {
+        return names[sprite];
+    }
+
+    void clear(TextureCache& texture_cache);
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    std::vector<Sprite> sprites;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, SpriteHandle, StringHash, std::equal_to<>> by_name;
+};
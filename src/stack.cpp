@@ -0,0 +1,117 @@
+#include <cassert>
+#include "frame_arena.h"
+#include "stack.h"
+
+
+static void renumber(Registry& registry, EntityHandle root, const std::vector<EntityHandle>& members, std::uint32_t from_index) {
+    for (std::uint32_t i = from_index; i < members.size(); ++i) {
+        TransformComponent& transform = registry.get<TransformComponent>(members[i]);
+        transform.stack_root = root;
+        transform.stack_index = i;
+    }
+}
+
+static void ensure_stack(Registry& registry, EntityHandle entity) {
+    TransformComponent& transform = registry.get<TransformComponent>(entity);
+
+    if (transform.stack_root != NULL_ENTITY) {
+        return;
+    }
+
+    transform.stack_root = entity;
+    transform.stack_index = 0;
+    registry.emplace<StackComponent>(entity, StackComponent{{entity}});
+}
+
+// Cuts the run out of its stack. When the root itself leaves, the stack is handed to the new bottom member.
+static EntityHandle detach_run(Registry& registry, EntityHandle first, std::uint32_t count, std::pmr::vector<EntityHandle>& run) {
+    TransformComponent& first_transform = registry.get<TransformComponent>(first);
+
+    if (first_transform.stack_root == NULL_ENTITY) {
+        assert(count == 1);
+        run.push_back(first);
+
+        return NULL_ENTITY;
+    }
+
+    EntityHandle root = first_transform.stack_root;
+    std::uint32_t index = first_transform.stack_index;
+    std::vector<EntityHandle>& members = registry.get<StackComponent>(root).members;
+    assert(index + count <= members.size());
+
+    run.assign(members.begin() + index, members.begin() + index + count);
+    members.erase(members.begin() + index, members.begin() + index + count);
+
+    for (EntityHandle member: run) {
+        registry.get<TransformComponent>(member).stack_root = NULL_ENTITY;
+    }
+
+    if (index > 0) {
+        renumber(registry, root, members, index);
+
+        return index < members.size() ? members[index] : NULL_ENTITY;
+    }
+
+    std::vector<EntityHandle> remaining = std::move(members);
+    registry.remove<StackComponent>(root);
+
+    if (remaining.empty()) {
+        return NULL_ENTITY;
+    }
+
+    if (remaining.size() == 1) {
+        TransformComponent& transform = registry.get<TransformComponent>(remaining.front());
+        transform.stack_root = NULL_ENTITY;
+        transform.stack_index = 0;
+
+        return remaining.front();
+    }
+
+    EntityHandle new_root = remaining.front();
+    renumber(registry, new_root, remaining, 0);
+    registry.emplace<StackComponent>(new_root, StackComponent{std::move(remaining)});
+
+    return new_root;
+}
+
+std::uint32_t stack_size(Registry& registry, EntityHandle entity) {
+    EntityHandle root = registry.get<TransformComponent>(entity).stack_root;
+
+    return root != NULL_ENTITY ? static_cast<std::uint32_t>(registry.get<StackComponent>(root).members.size()) : 1;
+}
+
+bool is_stack_top(Registry& registry, EntityHandle entity) {
+    return registry.get<TransformComponent>(entity).stack_index + 1 == stack_size(registry, entity);
+}
+
+EntityHandle stack_splice(Registry& registry, EntityHandle first, std::uint32_t count, EntityHandle target) {
+    std::pmr::vector<EntityHandle> run{&FrameArena::instance()};
+    run.reserve(count);
+
+    EntityHandle replacement = detach_run(registry, first, count, run);
+
+    ensure_stack(registry, target);
+
+    const TransformComponent& target_transform = registry.get<TransformComponent>(target);
+    EntityHandle root = target_transform.stack_root;
+    std::uint32_t index = target_transform.stack_index + 1;
+
+    std::vector<EntityHandle>& members = registry.get<StackComponent>(root).members;
+    members.insert(members.begin() + index, run.begin(), run.end());
+    renumber(registry, root, members, index);
+
+    return replacement;
+}
+
+EntityHandle stack_remove(Registry& registry, EntityHandle first, std::uint32_t count) {
+    std::pmr::vector<EntityHandle> run{&FrameArena::instance()};
+    run.reserve(count);
+
+    EntityHandle replacement = detach_run(registry, first, count, run);
+
+    for (EntityHandle member: run) {
+        registry.get<TransformComponent>(member).stack_index = 0;
+    }
+
+    return replacement;
+}
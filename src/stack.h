@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include "registry.h"
+
+
+[[nodiscard]] std::uint32_t stack_size(Registry& registry, EntityHandle entity);
+
+[[nodiscard]] bool is_stack_top(Registry& registry, EntityHandle entity);
+
+// Moves `count` consecutive members starting at `first` out of their stack and inserts them directly above `target`,
+// keeping their order. Cost is the size of the moved run plus whatever sits above the cut and the insertion point.
+// Returns the entity that took the place of `first` in the stack it left, or NULL_ENTITY if it left from the top.
+EntityHandle stack_splice(Registry& registry, EntityHandle first, std::uint32_t count, EntityHandle target);
+
+// Takes `count` consecutive members starting at `first` out of their stack, each of them ends up on its own.
+// Returns the entity that took the place of `first`, or NULL_ENTITY if they left from the top.
+EntityHandle stack_remove(Registry& registry, EntityHandle first, std::uint32_t count);
@@ -0,0 +1,1179 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include "allocation_counter.h"
+#include "frame_arena.h"
+#include "geometry.h"
+#include "job_system.h"
+#include "profiler.h"
+#include "stack.h"
+#include "table.h"
+
+
+constexpr const float SPATIAL_CELL_SIZE = 128.0F;
+
+constexpr const int DRAG_SYSTEM_PRIORITY = 100;
+constexpr const int DROP_SYSTEM_PRIORITY = 200;
+constexpr const int UPDATE_SYSTEM_PRIORITY = 300;
+constexpr const int GRID_SYSTEM_PRIORITY = 900;
+constexpr const int SYNC_POINT_PRIORITY = 1000;
+
+// Entities per job when screen recs are resolved or draggables are moved on the job system.
+constexpr const std::size_t SCREEN_REC_GRAIN = 1024;
+constexpr const std::size_t UPDATE_SYSTEM_GRAIN = 4096;
+constexpr const std::size_t SNAPSHOT_CAPTURE_GRAIN = 8192;
+
+Table::Table(Rectangle bounds) : spatial_grid{bounds, SPATIAL_CELL_SIZE} {
+    // Systems only look the spatial grid up, what they move is queued and filed into the grid by one system after them.
+    systems.add("Drag System", DRAG_SYSTEM_PRIORITY,
+                SystemAccess{}.read<RenderComponent, StackComponent>().write<TransformComponent, DraggableComponent>()
+                        .read(Resource::SpatialGrid).write(Resource::GridUpdates).write(Resource::RenderList),
+                [this] { drag_system(); });
+
+    systems.add("Drop System", DROP_SYSTEM_PRIORITY,
+                SystemAccess{}.read<TransformComponent, RenderComponent, StackComponent>().write<DraggableComponent>()
+                        .read(Resource::SpatialGrid).write(Resource::Commands),
+                [this] { drop_system(); });
+
+    systems.add("Update", UPDATE_SYSTEM_PRIORITY,
+                SystemAccess{}.read<DraggableComponent>().write<TransformComponent>().write(Resource::GridUpdates),
+                [this] { update_system(); });
+
+    systems.add("Spatial Grid", GRID_SYSTEM_PRIORITY,
+                SystemAccess{}.read<TransformComponent>().write(Resource::SpatialGrid).write(Resource::GridUpdates),
+                [this] { grid_system(); });
+
+    // Sync Point
+    systems.add("Apply Commands", SYNC_POINT_PRIORITY,
+                SystemAccess{}.write<TransformComponent, RenderComponent, DraggableComponent, StackableComponent, StackComponent>()
+                        .write(Resource::SpatialGrid).write(Resource::GridUpdates).write(Resource::RenderList)
+                        .write(Resource::Commands),
+                [this] { commands.apply(*this); });
+
+    systems.build();
+}
+
+bool Table::is_selected(EntityHandle entity) {
+    DraggableComponent* draggable = registry.try_get<DraggableComponent>(entity);
+
+    return draggable && draggable->is_selected;
+}
+
+bool Table::is_top_entity(EntityHandle entity) {
+    return is_stack_top(registry, entity);
+}
+
+Rectangle Table::resolve_screen_rec(EntityHandle entity) {
+    const TransformComponent& transform = registry.get<TransformComponent>(entity);
+
+    if (is_selected(entity)) {
+        return transform.rec;
+    }
+
+    Rectangle dest{transform.rec};
+
+    if (transform.stack_index > 0) {
+        const RenderComponent& render = registry.get<RenderComponent>(entity);
+        dest.x += render.offset_x * (float) transform.stack_index;
+        dest.y += render.offset_y * (float) transform.stack_index;
+    }
+
+    return dest;
+}
+
+void Table::store_screen_rec(EntityHandle entity, Rectangle rec) {
+    TransformComponent& transform = registry.get<TransformComponent>(entity);
+
+    // The first change in a tick keeps where the entity was at the end of the one before.
+    if (transform.screen_rec_tick != tick) {
+        transform.previous_screen_rec = transform.screen_rec;
+        transform.screen_rec_tick = tick;
+    }
+
+    transform.screen_rec = rec;
+}
+
+void Table::set_screen_rec(EntityHandle entity, Rectangle rec) {
+    store_screen_rec(entity, rec);
+    spatial_grid.update(entity, rec);
+}
+
+void Table::queue_screen_rec(EntityHandle entity, Rectangle rec) {
+    store_screen_rec(entity, rec);
+    grid_updates.push_back(entity);
+}
+
+// Resolving only touches each entity's own transform, so it is split over the job system. The grid and the render
+// list are then updated in order, which keeps them the same however the work was split.
+void Table::resolve_screen_recs(std::span<const EntityHandle> entities) {
+    JobSystem::instance().parallel_for(entities.size(), SCREEN_REC_GRAIN, [this, entities](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            store_screen_rec(entities[i], resolve_screen_rec(entities[i]));
+        }
+    });
+
+    for (EntityHandle entity: entities) {
+        spatial_grid.update(entity, registry.get<TransformComponent>(entity).screen_rec);
+        refresh_draw_order(entity);
+    }
+}
+
+Rectangle Table::get_interpolated_rec(EntityHandle entity, float alpha) {
+    const TransformComponent& transform = registry.get<TransformComponent>(entity);
+
+    // Before the first tick there is nothing to come from.
+    if (transform.screen_rec_tick != tick || tick == 0) {
+        return transform.screen_rec;
+    }
+
+    const Rectangle& from = transform.previous_screen_rec;
+    const Rectangle& to = transform.screen_rec;
+
+    return Rectangle{
+            from.x + (to.x - from.x) * alpha,
+            from.y + (to.y - from.y) * alpha,
+            from.width + (to.width - from.width) * alpha,
+            from.height + (to.height - from.height) * alpha
+    };
+}
+
+void Table::refresh_draw_order(EntityHandle entity) {
+    if (!registry.has<RenderComponent>(entity)) {
+        return;
+    }
+
+    RenderList::Key key{RenderLayer::Table, registry.get<TransformComponent>(entity).stack_index};
+
+    if (is_selected(entity)) {
+        key.layer = RenderLayer::Overlay;
+    }
+
+    render_list.update(entity, key);
+}
+
+// Re-resolves the cached screen rec and draw order of the entity and of everything stacked on top of it.
+void Table::refresh_screen_recs(EntityHandle entity) {
+    TransformComponent& transform = registry.get<TransformComponent>(entity);
+
+    if (transform.stack_root == NULL_ENTITY) {
+        set_screen_rec(entity, resolve_screen_rec(entity));
+        refresh_draw_order(entity);
+
+        return;
+    }
+
+    const std::vector<EntityHandle>& members = registry.get<StackComponent>(transform.stack_root).members;
+    resolve_screen_recs(std::span<const EntityHandle>{members}.subspan(transform.stack_index));
+}
+
+// Only entities the spatial grid has around `area` are tested.
+template<typename... Ts>
+EntityHandle Table::top_entity(Rectangle area, const std::function<bool(EntityHandle)>& predicate) {
+    std::pmr::vector<EntityHandle> candidates{&FrameArena::instance()};
+    spatial_grid.query(area, candidates);
+
+    for (EntityHandle other_entity: candidates) {
+        if (!registry.has_all<TransformComponent, Ts...>(other_entity) || !predicate(other_entity)) {
+            continue;
+        }
+
+        if (is_top_entity(other_entity)) {
+            return other_entity;
+        }
+    }
+
+    return NULL_ENTITY;
+}
+
+// Only entities the spatial grid has around `rec` are tested.
+template<typename... Ts>
+EntityHandle Table::closest_entity(Rectangle rec, const std::function<bool(EntityHandle)>& predicate) {
+    float closest_dist = std::numeric_limits<float>::max();
+    Rectangle close_rec;
+
+    std::pmr::vector<EntityHandle> candidates{&FrameArena::instance()};
+    spatial_grid.query(rec, candidates);
+
+    std::erase_if(candidates, [this, &predicate](EntityHandle other_entity) {
+        return !registry.has_all<TransformComponent, Ts...>(other_entity) || !predicate(other_entity);
+    });
+
+    for (EntityHandle other_entity: candidates) {
+        Rectangle other_rec = get_screen_rec(other_entity);
+        float dist_to_drop = RecDistSqr(rec, other_rec);
+
+        if (dist_to_drop < closest_dist) {
+            close_rec = other_rec;
+            closest_dist = dist_to_drop;
+        }
+    }
+
+    std::pmr::vector<EntityHandle> stackable_entities{&FrameArena::instance()};
+
+    for (EntityHandle other_entity: candidates) {
+        if (!(rec_equals(close_rec, get_screen_rec(other_entity)))) {
+            continue;
+        }
+
+        stackable_entities.push_back(other_entity);
+    }
+
+    if (stackable_entities.size() == 1) {
+        return stackable_entities.front();
+    }
+
+    for (EntityHandle stackable_entity: stackable_entities) {
+        if (is_top_entity(stackable_entity)) {
+            return stackable_entity;
+        }
+    }
+
+    return NULL_ENTITY;
+}
+
+void Table::move_to_entity(EntityHandle entity, EntityHandle other_entity) {
+    TransformComponent& transform = registry.get<TransformComponent>(entity);
+    const TransformComponent& other_transform = registry.get<TransformComponent>(other_entity);
+
+    transform.rec.x = other_transform.rec.x;
+    transform.rec.y = other_transform.rec.y;
+}
+
+void Table::stack_to_entity(EntityHandle entity_to_stack, EntityHandle other_entity) {
+    if (!registry.has<StackableComponent>(other_entity)) {
+        printf("Unable to stack as the other_entity is not stackable.\n");
+
+        return;
+    }
+
+    EntityHandle replacement_entity = stack_splice(registry, entity_to_stack, 1, other_entity);
+
+    if (RenderComponent* render = registry.try_get<RenderComponent>(entity_to_stack)) {
+        const RenderComponent& other_render = registry.get<RenderComponent>(other_entity);
+        render->offset_x = other_render.offset_x;
+        render->offset_y = other_render.offset_y;
+    }
+
+    move_to_entity(entity_to_stack, other_entity);
+
+    // The run left behind moved one place down, the stacked entity and everything above it are at a new depth.
+    if (replacement_entity != NULL_ENTITY) {
+        refresh_screen_recs(replacement_entity);
+    }
+
+    refresh_screen_recs(entity_to_stack);
+}
+
+void Table::detach(EntityHandle entity) {
+    TransformComponent& transform = registry.get<TransformComponent>(entity);
+
+    if (transform.stack_root == NULL_ENTITY) {
+        return;
+    }
+
+    EntityHandle replacement_entity = stack_remove(registry, entity, 1);
+    transform.rec.x = transform.screen_rec.x;
+    transform.rec.y = transform.screen_rec.y;
+
+    if (replacement_entity != NULL_ENTITY) {
+        refresh_screen_recs(replacement_entity);
+    }
+
+    refresh_screen_recs(entity);
+}
+
+void Table::move(EntityHandle entity, Vector2 position) {
+    TransformComponent& transform = registry.get<TransformComponent>(entity);
+    transform.rec.x = position.x;
+    transform.rec.y = position.y;
+
+    if (transform.stack_root != NULL_ENTITY) {
+        const std::vector<EntityHandle>& members = registry.get<StackComponent>(transform.stack_root).members;
+
+        for (std::size_t i = transform.stack_index + 1; i < members.size(); ++i) {
+            Rectangle& rec = registry.get<TransformComponent>(members[i]).rec;
+            rec.x = position.x;
+            rec.y = position.y;
+        }
+    }
+
+    refresh_screen_recs(entity);
+}
+
+void Table::destroy(EntityHandle entity) {
+    if (!registry.is_valid(entity)) {
+        return;
+    }
+
+    detach(entity);
+    spatial_grid.remove(entity);
+    render_list.remove(entity);
+    registry.destroy(entity);
+}
+
+EntityHandle Table::pick(Vector2 point) {
+    auto closest_draggable = [this, point](EntityHandle other_entity) -> bool {
+        // TODO: Handle entities that doesn't stack in the future.
+        // TODO: Create a function that creates a rectangle from mouse cursor with some arbitrary size
+        return point_in_rec(point, get_screen_rec(other_entity));
+    };
+
+    return top_entity<DraggableComponent>(Rectangle{point.x, point.y, 0.0F, 0.0F}, closest_draggable);
+}
+
+EntityHandle Table::drop_target(EntityHandle entity) {
+    auto closest_stackable = [this, entity](EntityHandle other_entity) -> bool {
+        if (entity == other_entity) {
+            return false;
+        }
+
+        return recs_overlap(get_screen_rec(entity), get_screen_rec(other_entity));
+    };
+
+    return closest_entity(get_screen_rec(entity), closest_stackable);
+}
+
+EntityHandle Table::create_card(Vector2 position, SpriteHandle sprite, bool is_stackable) {
+    EntityHandle entity = registry.create(uuid_rng());
+
+    registry.emplace<TransformComponent>(entity, Rectangle{position.x, position.y, CARD_WIDTH, CARD_HEIGHT});
+    registry.emplace<RenderComponent>(entity, sprite, 0.0F, 0.0F);
+    registry.emplace<DraggableComponent>(entity);
+
+    if (is_stackable) {
+        registry.emplace<StackableComponent>(entity);
+    }
+
+    refresh_screen_recs(entity);
+
+    return entity;
+}
+
+EntityHandle Table::create_slot(Vector2 position, float offset_x, float offset_y) {
+    EntityHandle entity = registry.create(uuid_rng());
+
+    registry.emplace<TransformComponent>(entity, Rectangle{position.x, position.y, CARD_WIDTH, CARD_HEIGHT});
+    registry.emplace<RenderComponent>(entity, NULL_SPRITE, offset_x, offset_y);
+    registry.emplace<StackableComponent>(entity);
+
+    refresh_screen_recs(entity);
+
+    return entity;
+}
+
+void Table::spawn_layout(const LayoutPlan& layout, Vector2 origin, std::span<const SpriteHandle> deck) {
+    if (layout.error) {
+        printf("Unable to spawn a layout that did not parse: %s at %zu.\n", layout.error, layout.error_offset);
+
+        return;
+    }
+
+    std::span<const LayoutPile> piles{layout.piles.data(), layout.pile_count};
+    std::size_t counted_cards = 0;
+
+    for (const LayoutPile& pile: piles) {
+        counted_cards += pile.rest ? 0 : pile.cards;
+    }
+
+    std::size_t rest_cards = deck.size() > counted_cards ? deck.size() - counted_cards : 0;
+    std::size_t card_count = std::min(deck.size(), counted_cards + rest_cards);
+
+    registry.storage<TransformComponent>().reserve(registry.storage<TransformComponent>().size() + piles.size() + card_count);
+    registry.storage<RenderComponent>().reserve(registry.storage<RenderComponent>().size() + piles.size() + card_count);
+    registry.storage<DraggableComponent>().reserve(registry.storage<DraggableComponent>().size() + card_count);
+    registry.storage<StackableComponent>().reserve(registry.storage<StackableComponent>().size() + piles.size() + card_count);
+    registry.storage<StackComponent>().reserve(registry.storage<StackComponent>().size() + piles.size());
+
+    // Entities are only created here, their screen recs, grid cells and draw order are filled in one pass at the end.
+    std::vector<EntityHandle> created;
+    created.reserve(piles.size() + card_count);
+
+    // Piles with a count are dealt in pattern order, the first '*' pile gets what is left after all of them.
+    std::size_t next_card = 0;
+    bool rest_dealt = false;
+
+    for (const LayoutPile& pile: piles) {
+        std::size_t first = pile.rest ? counted_cards : next_card;
+        std::size_t count = pile.rest ? (rest_dealt ? 0 : rest_cards) : std::min<std::size_t>(pile.cards, deck.size() - next_card);
+        rest_dealt = rest_dealt || pile.rest;
+        next_card += pile.rest ? 0 : count;
+
+        Rectangle rec{origin.x + pile.column * (CARD_WIDTH + CARD_SPACING), origin.y + pile.row * (CARD_HEIGHT + CARD_SPACING), CARD_WIDTH, CARD_HEIGHT};
+        EntityHandle slot = registry.create(uuid_rng());
+        registry.emplace<TransformComponent>(slot, rec);
+        registry.emplace<RenderComponent>(slot, NULL_SPRITE, pile.fan.x, pile.fan.y);
+        registry.emplace<StackableComponent>(slot);
+        created.push_back(slot);
+
+        if (count > 0) {
+            std::vector<EntityHandle> members;
+            members.reserve(count + 1);
+            members.push_back(slot);
+
+            for (std::size_t i = 0; i < count; ++i) {
+                bool face_up = pile.face == LayoutFace::Up || (pile.face == LayoutFace::TopUp && i + 1 == count);
+                EntityHandle card = registry.create(uuid_rng());
+
+                TransformComponent& transform = registry.emplace<TransformComponent>(card, rec);
+                transform.stack_root = slot;
+                transform.stack_index = (std::uint32_t) members.size();
+
+                registry.emplace<RenderComponent>(card, deck[first + i], pile.fan.x, pile.fan.y, face_up);
+                registry.emplace<DraggableComponent>(card);
+                registry.emplace<StackableComponent>(card);
+                members.push_back(card);
+                created.push_back(card);
+            }
+
+            registry.get<TransformComponent>(slot).stack_root = slot;
+            registry.emplace<StackComponent>(slot, StackComponent{std::move(members)});
+        }
+    }
+
+    render_list.reserve(created.size());
+    resolve_screen_recs(created);
+
+    if (counted_cards > deck.size()) {
+        printf("Unable to deal every pile as the layout needs %zu cards and the deck has %zu.\n", counted_cards, deck.size());
+    }
+}
+
+void Table::step(const InputFrame& input) {
+    PROFILE_SCOPE("Table Step");
+    ++tick;
+
+    drops.clear();
+
+    // Event
+    input_frame = input;
+    pointer_event = PointerEvent::None;
+
+    if (!left_clicked && input.pressed) {
+        left_clicked = true;
+        // User just pressed left click
+        pointer_event = PointerEvent::Pressed;
+    } else if (left_clicked && input.released) {
+        left_clicked = false;
+        // User just released left click
+        pointer_event = PointerEvent::Released;
+    }
+
+    // Undo and redo wait until nothing is held or being dropped.
+    if (!left_clicked && pointer_event == PointerEvent::None && (input.undo || input.redo)) {
+        if (const DropEvent* drop = input.undo ? history.undo(*this) : history.redo(*this)) {
+            DropEvent& event = drops.emplace_back(*drop);
+            event.tick = tick;
+            event.action = input.undo ? DropAction::Undo : DropAction::Redo;
+        }
+    }
+
+    systems.run(&JobSystem::instance());
+
+    // Drops that went nowhere changed nothing worth undoing.
+    for (const DropEvent& drop: drops) {
+        if (drop.action == DropAction::Drop && drop.target != NULL_ENTITY) {
+            history.record(drop);
+        }
+    }
+}
+
+void Table::apply_drop(const DropEvent& drop) {
+    if (!registry.is_valid(drop.entity) || !registry.has_all<TransformComponent, DraggableComponent>(drop.entity)) {
+        return;
+    }
+
+    registry.get<TransformComponent>(drop.entity).last_rec = drop.last_rec;
+    registry.get<DraggableComponent>(drop.entity).is_selected = false;
+
+    if (drop.target != NULL_ENTITY && registry.is_valid(drop.target)) {
+        stack_to_entity(drop.entity, drop.target);
+    } else {
+        move(drop.entity, Vector2{drop.last_rec.x, drop.last_rec.y});
+    }
+}
+
+void Table::revert_drop(const DropEvent& drop) {
+    if (!registry.is_valid(drop.entity) || !registry.has<TransformComponent>(drop.entity)) {
+        return;
+    }
+
+    // A drop that found nothing to stack on left the links as they were.
+    if (drop.target != NULL_ENTITY) {
+        detach(drop.entity);
+
+        if (drop.below != NULL_ENTITY && registry.is_valid(drop.below)) {
+            stack_splice(registry, drop.entity, 1, drop.below);
+        } else if (drop.above != NULL_ENTITY && registry.is_valid(drop.above)) {
+            // It was the bottom, what stood on it goes back on top of it.
+            std::uint32_t above_index = registry.get<TransformComponent>(drop.above).stack_index;
+            stack_splice(registry, drop.above, stack_size(registry, drop.above) - above_index, drop.entity);
+        }
+
+        if (RenderComponent* render = registry.try_get<RenderComponent>(drop.entity)) {
+            render->offset_x = drop.offset.x;
+            render->offset_y = drop.offset.y;
+        }
+    }
+
+    registry.get<TransformComponent>(drop.entity).last_rec = drop.last_rec;
+    move(drop.entity, Vector2{drop.last_rec.x, drop.last_rec.y});
+}
+
+void Table::drag_system() {
+    if (pointer_event != PointerEvent::Pressed) {
+        return;
+    }
+
+    ALLOC_SCOPE(AllocTag::Event);
+    EntityHandle entity_to_select = pick(input_frame.pointer);
+
+    if (entity_to_select != NULL_ENTITY) {
+        TransformComponent& transform = registry.get<TransformComponent>(entity_to_select);
+        transform.last_rec = transform.rec;
+        queue_screen_rec(entity_to_select, transform.rec);
+        registry.get<DraggableComponent>(entity_to_select).is_selected = true;
+        refresh_draw_order(entity_to_select);
+    }
+}
+
+DropEvent Table::drop_event(EntityHandle entity, EntityHandle target) {
+    const TransformComponent& transform = registry.get<TransformComponent>(entity);
+    const RenderComponent* render = registry.try_get<RenderComponent>(entity);
+    DropEvent drop{tick, DropAction::Drop, entity, target, NULL_ENTITY, NULL_ENTITY, transform.last_rec,
+                   render ? Vector2{render->offset_x, render->offset_y} : Vector2{}};
+
+    if (transform.stack_root != NULL_ENTITY) {
+        const std::vector<EntityHandle>& members = registry.get<StackComponent>(transform.stack_root).members;
+
+        if (transform.stack_index > 0) {
+            drop.below = members[transform.stack_index - 1];
+        } else if (members.size() > 1) {
+            drop.above = members[1];
+        }
+    }
+
+    return drop;
+}
+
+void Table::drop_system() {
+    if (pointer_event != PointerEvent::Released) {
+        return;
+    }
+
+    ALLOC_SCOPE(AllocTag::Event);
+
+    for (EntityHandle entity: registry.view<TransformComponent, DraggableComponent>()) {
+        const TransformComponent& transform = registry.get<TransformComponent>(entity);
+        DraggableComponent& draggable = registry.get<DraggableComponent>(entity);
+
+        if (draggable.is_selected) {
+            EntityHandle stackable_entity = drop_target(entity);
+
+            // TODO: Handle entities that doesn't stack in the future.
+            if (stackable_entity != NULL_ENTITY) {
+                commands.attach_to_stack(entity, stackable_entity);
+            } else {
+                printf("Cannot find stackable entity so moved to last known position.\n");
+                commands.move(entity, Vector2{transform.last_rec.x, transform.last_rec.y});
+            }
+
+            // Either command re-resolves the screen rec, by then it is drawn as part of the table again.
+            draggable.is_selected = false;
+            drops.push_back(drop_event(entity, stackable_entity));
+        }
+    }
+}
+
+void Table::update_system() {
+    ALLOC_SCOPE(AllocTag::Update);
+
+    const SparseSet<DraggableComponent>& draggables = registry.storage<DraggableComponent>();
+    moved_chunks.assign((draggables.size() + UPDATE_SYSTEM_GRAIN - 1) / UPDATE_SYSTEM_GRAIN, 0);
+
+    // Each job moves the selected entities of its own chunk of the pool and flags the chunk.
+    JobSystem::instance().parallel_for(draggables.size(), UPDATE_SYSTEM_GRAIN, [this, &draggables](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            EntityHandle entity = draggables.entities()[i];
+            TransformComponent* transform = registry.try_get<TransformComponent>(entity);
+
+            if (!draggables.components()[i].is_selected || !transform) {
+                continue;
+            }
+
+            // Entity Update Loop:
+            transform->rec.x = input_frame.pointer.x - transform->rec.width * 0.5F;
+            transform->rec.y = input_frame.pointer.y - transform->rec.height * 0.5F;
+            store_screen_rec(entity, transform->rec);
+            moved_chunks[i / UPDATE_SYSTEM_GRAIN] = 1;
+        }
+    });
+
+    // Queued in pool order, only the flagged chunks are walked again.
+    for (std::size_t chunk = 0; chunk < moved_chunks.size(); ++chunk) {
+        if (!moved_chunks[chunk]) {
+            continue;
+        }
+
+        std::size_t end = std::min(draggables.size(), (chunk + 1) * UPDATE_SYSTEM_GRAIN);
+
+        for (std::size_t i = chunk * UPDATE_SYSTEM_GRAIN; i < end; ++i) {
+            if (draggables.components()[i].is_selected && registry.has<TransformComponent>(draggables.entities()[i])) {
+                grid_updates.push_back(draggables.entities()[i]);
+            }
+        }
+    }
+}
+
+void Table::grid_system() {
+    for (EntityHandle entity: grid_updates) {
+        if (const TransformComponent* transform = registry.try_get<TransformComponent>(entity)) {
+            spatial_grid.update(entity, transform->screen_rec);
+        }
+    }
+
+    grid_updates.clear();
+}
+
+void Table::reseed(std::uint32_t seed_) {
+    seed = seed_;
+    rng.seed(seed);
+}
+
+// FNV-1a, over the raw bytes of each value.
+template<typename T>
+static void hash_value(std::uint64_t& hash, const T& value) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+}
+
+static void hash_rec(std::uint64_t& hash, Rectangle rec) {
+    hash_value(hash, rec.x);
+    hash_value(hash, rec.y);
+    hash_value(hash, rec.width);
+    hash_value(hash, rec.height);
+}
+
+std::uint64_t Table::state_hash() const {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    hash_value(hash, tick);
+    hash_value(hash, left_clicked);
+
+    // Pools are dense arrays in insertion order, the same for two runs that did the same.
+    const SparseSet<TransformComponent>& transforms = registry.storage<TransformComponent>();
+
+    for (std::size_t i = 0; i < transforms.size(); ++i) {
+        const TransformComponent& transform = transforms.components()[i];
+        hash_value(hash, transforms.entities()[i].raw());
+        hash_rec(hash, transform.rec);
+        hash_rec(hash, transform.last_rec);
+        hash_rec(hash, transform.screen_rec);
+        hash_value(hash, transform.stack_root.raw());
+        hash_value(hash, transform.stack_index);
+    }
+
+    // Sprite handles are per run, only which side is up is state.
+    const SparseSet<RenderComponent>& renders = registry.storage<RenderComponent>();
+
+    for (std::size_t i = 0; i < renders.size(); ++i) {
+        hash_value(hash, renders.entities()[i].raw());
+        hash_value(hash, renders.components()[i].face_up);
+    }
+
+    const SparseSet<DraggableComponent>& draggables = registry.storage<DraggableComponent>();
+
+    for (std::size_t i = 0; i < draggables.size(); ++i) {
+        hash_value(hash, draggables.entities()[i].raw());
+        hash_value(hash, draggables.components()[i].is_selected);
+    }
+
+    const SparseSet<StackComponent>& stacks = registry.storage<StackComponent>();
+
+    for (std::size_t i = 0; i < stacks.size(); ++i) {
+        hash_value(hash, stacks.entities()[i].raw());
+
+        for (EntityHandle member: stacks.components()[i].members) {
+            hash_value(hash, member.raw());
+        }
+    }
+
+    return hash;
+}
+
+static void copy_rec(float (&to)[4], Rectangle rec) {
+    to[0] = rec.x;
+    to[1] = rec.y;
+    to[2] = rec.width;
+    to[3] = rec.height;
+}
+
+static Rectangle to_rec(const float (&from)[4]) {
+    return Rectangle{from[0], from[1], from[2], from[3]};
+}
+
+bool Table::write_snapshot(const char* file_name, const std::function<std::string_view(SpriteHandle)>& sprite_name) const {
+    std::vector<unsigned char> file_data;
+
+    return encode_snapshot(sprite_name, file_data) && write_snapshot_file(file_name, file_data);
+}
+
+bool Table::encode_snapshot(const std::function<std::string_view(SpriteHandle)>& sprite_name, std::vector<unsigned char>& file_data) const {
+    SnapshotData snapshot_data;
+
+    if (!capture_snapshot(sprite_name, snapshot_data)) {
+        return false;
+    }
+
+    encode_snapshot_file(snapshot_data, file_data);
+
+    return true;
+}
+
+bool Table::capture_snapshot(const std::function<std::string_view(SpriteHandle)>& sprite_name, SnapshotData& snapshot_data) const {
+    const std::vector<std::uint32_t>& generations = registry.slot_generations();
+    const std::vector<EntityId>& ids = registry.slot_ids();
+
+    JobSystem& job_system = JobSystem::instance();
+
+    // Slots and transforms are copied record by record into place, which splits over the job system.
+    snapshot_data.slots.resize(generations.size());
+
+    job_system.parallel_for(generations.size(), SNAPSHOT_CAPTURE_GRAIN, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t index = begin; index < end; ++index) {
+            SnapshotSlot& slot = snapshot_data.slots[index];
+            std::memcpy(slot.id, ids[index].as_bytes().data(), sizeof(slot.id));
+            slot.generation = generations[index];
+        }
+    });
+
+    snapshot_data.free_indices.assign(registry.free_slots().begin(), registry.free_slots().end());
+
+    const SparseSet<TransformComponent>& transforms = registry.storage<TransformComponent>();
+    snapshot_data.transforms.resize(transforms.size());
+
+    job_system.parallel_for(transforms.size(), SNAPSHOT_CAPTURE_GRAIN, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const TransformComponent& transform = transforms.components()[i];
+            SnapshotTransform& snapshot_transform = snapshot_data.transforms[i];
+            snapshot_transform.entity = transforms.entities()[i].raw();
+            snapshot_transform.stack_root = transform.stack_root.raw();
+            snapshot_transform.stack_index = transform.stack_index;
+            copy_rec(snapshot_transform.rec, transform.rec);
+            copy_rec(snapshot_transform.last_rec, transform.last_rec);
+            copy_rec(snapshot_transform.screen_rec, transform.screen_rec);
+        }
+    });
+
+    // Sprites are saved by name, each name once. Handles are indices into the sprite table, so they index this too.
+    std::vector<SnapshotSprite>& sprites = snapshot_data.sprites;
+    std::vector<std::uint32_t> sprite_indices;
+    sprites.clear();
+
+    const SparseSet<RenderComponent>& renders = registry.storage<RenderComponent>();
+    snapshot_data.renders.resize(renders.size());
+
+    for (std::size_t i = 0; i < renders.size(); ++i) {
+        const RenderComponent& render = renders.components()[i];
+        std::uint32_t sprite = SNAPSHOT_NULL_SPRITE;
+
+        if (render.sprite != NULL_SPRITE) {
+            if (render.sprite >= sprite_indices.size()) {
+                sprite_indices.resize(render.sprite + 1, SNAPSHOT_NULL_SPRITE);
+            }
+
+            std::uint32_t& sprite_index = sprite_indices[render.sprite];
+
+            if (sprite_index == SNAPSHOT_NULL_SPRITE) {
+                std::string_view name = sprite_name(render.sprite);
+
+                if (name.size() >= sizeof(SnapshotSprite::name)) {
+                    printf("Unable to write snapshot as %.*s is too long of a sprite name.\n", (int) name.size(), name.data());
+
+                    return false;
+                }
+
+                sprite_index = (std::uint32_t) sprites.size();
+                SnapshotSprite& snapshot_sprite = sprites.emplace_back();
+                std::memcpy(snapshot_sprite.name, name.data(), name.size());
+            }
+
+            sprite = sprite_index;
+        }
+
+        snapshot_data.renders[i] = SnapshotRender{renders.entities()[i].raw(), sprite, render.offset_x, render.offset_y, render.face_up ? 1U : 0U};
+    }
+
+    const SparseSet<DraggableComponent>& draggables = registry.storage<DraggableComponent>();
+    snapshot_data.draggables.resize(draggables.size());
+
+    for (std::size_t i = 0; i < draggables.size(); ++i) {
+        snapshot_data.draggables[i] = SnapshotDraggable{draggables.entities()[i].raw(), draggables.components()[i].is_selected ? 1U : 0U};
+    }
+
+    snapshot_data.stackables.clear();
+
+    for (EntityHandle entity: registry.storage<StackableComponent>().entities()) {
+        snapshot_data.stackables.push_back(entity.raw());
+    }
+
+    const SparseSet<StackComponent>& stacks = registry.storage<StackComponent>();
+    std::vector<std::uint32_t>& members = snapshot_data.members;
+    snapshot_data.stacks.resize(stacks.size());
+    members.clear();
+
+    for (std::size_t i = 0; i < stacks.size(); ++i) {
+        const std::vector<EntityHandle>& stack_members = stacks.components()[i].members;
+        snapshot_data.stacks[i] = SnapshotStack{stacks.entities()[i].raw(), (std::uint32_t) members.size(), (std::uint32_t) stack_members.size()};
+
+        for (EntityHandle member: stack_members) {
+            members.push_back(member.raw());
+        }
+    }
+
+    snapshot_data.draw_order.clear();
+
+    for (const RenderList::Entry& entry: render_list.entries()) {
+        snapshot_data.draw_order.push_back(entry.entity.raw());
+    }
+
+    snapshot_data.grid_cells.clear();
+    snapshot_data.grid_entities.clear();
+
+    for (const std::vector<EntityHandle>& cell: spatial_grid.get_cells()) {
+        snapshot_data.grid_cells.push_back((std::uint32_t) cell.size());
+
+        for (EntityHandle entity: cell) {
+            snapshot_data.grid_entities.push_back(entity.raw());
+        }
+    }
+
+    std::ostringstream rng_state;
+    rng_state << rng;
+    snapshot_data.rng_state = rng_state.str();
+    snapshot_data.tick = tick;
+    snapshot_data.seed = seed;
+    snapshot_data.left_clicked = left_clicked;
+
+    return true;
+}
+
+// Everything load_snapshot relies on without checking: every handle names a live slot, no entity is in a section
+// twice, every component sits on an entity with a transform, stacks and their members agree with each other, and free
+// slots are free. All of it is checked before the table is touched, a damaged file leaves it as it was.
+static bool is_snapshot_consistent(const Snapshot& snapshot) {
+    std::span<const SnapshotSlot> slots = snapshot.slots();
+
+    enum Presence : std::uint8_t {
+        HAS_TRANSFORM = 1U << 0U,
+        HAS_RENDER = 1U << 1U,
+        HAS_DRAGGABLE = 1U << 2U,
+        HAS_STACKABLE = 1U << 3U,
+        HAS_STACK = 1U << 4U,
+        IS_DRAWN = 1U << 5U,
+        IS_FREE = 1U << 6U,
+    };
+
+    std::vector<std::uint8_t> presence(slots.size(), 0);
+
+    auto is_live = [&slots](std::uint32_t raw) {
+        EntityHandle entity = EntityHandle::from_raw(raw);
+
+        return entity.index() < slots.size() && slots[entity.index()].generation == entity.generation();
+    };
+
+    // Marks the entity and fails if it is not live or already has the mark.
+    auto mark = [&presence, &is_live](std::uint32_t raw, std::uint8_t bit) {
+        if (!is_live(raw)) {
+            return false;
+        }
+
+        std::uint8_t& flags = presence[EntityHandle::from_raw(raw).index()];
+
+        if (flags & bit) {
+            return false;
+        }
+
+        flags |= bit;
+
+        return true;
+    };
+
+    auto has = [&presence, &is_live](std::uint32_t raw, std::uint8_t bits) {
+        return is_live(raw) && (presence[EntityHandle::from_raw(raw).index()] & bits) == bits;
+    };
+
+    for (std::uint32_t index: snapshot.free_indices()) {
+        if (index >= slots.size() || (presence[index] & IS_FREE)) {
+            return false;
+        }
+
+        presence[index] |= IS_FREE;
+    }
+
+    // Position of each entity's transform in the transforms section.
+    std::vector<std::uint32_t> transform_of(slots.size(), 0);
+
+    for (std::size_t i = 0; i < snapshot.transforms().size(); ++i) {
+        const SnapshotTransform& transform = snapshot.transforms()[i];
+
+        if (!mark(transform.entity, HAS_TRANSFORM)) {
+            return false;
+        }
+
+        transform_of[EntityHandle::from_raw(transform.entity).index()] = (std::uint32_t) i;
+    }
+
+    for (const SnapshotRender& render: snapshot.renders()) {
+        if (!mark(render.entity, HAS_RENDER) || (render.sprite != SNAPSHOT_NULL_SPRITE && render.sprite >= snapshot.sprites().size())) {
+            return false;
+        }
+    }
+
+    for (const SnapshotDraggable& draggable: snapshot.draggables()) {
+        if (!mark(draggable.entity, HAS_DRAGGABLE)) {
+            return false;
+        }
+    }
+
+    for (std::uint32_t stackable: snapshot.stackables()) {
+        if (!mark(stackable, HAS_STACKABLE)) {
+            return false;
+        }
+    }
+
+    // Position of each entity's stack in the stacks section.
+    std::vector<std::uint32_t> stack_of(slots.size(), 0);
+
+    for (std::size_t i = 0; i < snapshot.stacks().size(); ++i) {
+        const SnapshotStack& stack = snapshot.stacks()[i];
+
+        if (!mark(stack.entity, HAS_STACK) || stack.members_begin > snapshot.members().size() ||
+            stack.members_count > snapshot.members().size() - stack.members_begin || stack.members_count == 0 ||
+            snapshot.members()[stack.members_begin] != stack.entity) {
+            return false;
+        }
+
+        stack_of[EntityHandle::from_raw(stack.entity).index()] = (std::uint32_t) i;
+    }
+
+    for (std::size_t index = 0; index < slots.size(); ++index) {
+        std::uint8_t flags = presence[index];
+
+        // A free slot holds nothing, everything else needs somewhere to be.
+        if ((flags & IS_FREE) && flags != IS_FREE) {
+            return false;
+        }
+
+        if ((flags & (HAS_RENDER | HAS_DRAGGABLE | HAS_STACKABLE | HAS_STACK)) && !(flags & HAS_TRANSFORM)) {
+            return false;
+        }
+    }
+
+    // Members and transforms have to agree both ways: a member's transform names its stack and place in it, and a
+    // transform in a stack is listed there at its own index.
+    for (const SnapshotStack& stack: snapshot.stacks()) {
+        std::span<const std::uint32_t> members = snapshot.members().subspan(stack.members_begin, stack.members_count);
+
+        for (std::size_t i = 0; i < members.size(); ++i) {
+            if (!has(members[i], HAS_TRANSFORM)) {
+                return false;
+            }
+
+            const SnapshotTransform& transform = snapshot.transforms()[transform_of[EntityHandle::from_raw(members[i]).index()]];
+
+            if (transform.stack_root != stack.entity || transform.stack_index != i) {
+                return false;
+            }
+        }
+    }
+
+    for (const SnapshotTransform& transform: snapshot.transforms()) {
+        if (transform.stack_root == NULL_ENTITY.raw()) {
+            continue;
+        }
+
+        if (!has(transform.stack_root, HAS_STACK | HAS_TRANSFORM)) {
+            return false;
+        }
+
+        const SnapshotStack& stack = snapshot.stacks()[stack_of[EntityHandle::from_raw(transform.stack_root).index()]];
+
+        if (transform.stack_index >= stack.members_count || snapshot.members()[stack.members_begin + transform.stack_index] != transform.entity) {
+            return false;
+        }
+    }
+
+    for (std::uint32_t entity: snapshot.draw_order()) {
+        if (!has(entity, HAS_TRANSFORM | HAS_RENDER) || !mark(entity, IS_DRAWN)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Table::load_snapshot(const Snapshot& snapshot, const std::function<SpriteHandle(std::string_view)>& sprite_for) {
+    if (!is_snapshot_consistent(snapshot)) {
+        printf("Unable to load snapshot as it is damaged.\n");
+
+        return false;
+    }
+
+    clear();
+
+    std::span<const SnapshotSlot> slots = snapshot.slots();
+    std::vector<std::uint32_t> generations(slots.size());
+    std::vector<EntityId> ids(slots.size());
+
+    for (std::size_t index = 0; index < slots.size(); ++index) {
+        generations[index] = slots[index].generation;
+        ids[index] = EntityId{std::begin(slots[index].id), std::end(slots[index].id)};
+    }
+
+    registry.restore(std::move(generations), std::move(ids), {snapshot.free_indices().begin(), snapshot.free_indices().end()});
+
+    registry.storage<TransformComponent>().reserve(snapshot.transforms().size());
+
+    // Candidates come out of the grid in cell order, which decides between overlapping stacks. A grid of the saved
+    // size is sized up front and gets its cell order back below, one of another size keeps the order of the transforms.
+    std::span<const std::uint32_t> grid_cells = snapshot.grid_cells();
+    std::span<const std::uint32_t> grid_entities = snapshot.grid_entities();
+    bool is_same_grid = grid_cells.size() == spatial_grid.get_cells().size();
+
+    for (std::size_t index = 0; is_same_grid && index < grid_cells.size(); ++index) {
+        spatial_grid.reserve_cell(index, std::min<std::size_t>(grid_cells[index], grid_entities.size()));
+    }
+
+    for (const SnapshotTransform& snapshot_transform: snapshot.transforms()) {
+        EntityHandle entity = EntityHandle::from_raw(snapshot_transform.entity);
+        TransformComponent& transform = registry.emplace<TransformComponent>(entity, to_rec(snapshot_transform.rec));
+        transform.last_rec = to_rec(snapshot_transform.last_rec);
+        transform.screen_rec = to_rec(snapshot_transform.screen_rec);
+        transform.previous_screen_rec = transform.screen_rec;
+        transform.stack_root = EntityHandle::from_raw(snapshot_transform.stack_root);
+        transform.stack_index = snapshot_transform.stack_index;
+        spatial_grid.update(entity, transform.screen_rec);
+    }
+
+    std::vector<SpriteHandle> sprites;
+    sprites.reserve(snapshot.sprites().size());
+
+    for (const SnapshotSprite& sprite: snapshot.sprites()) {
+        sprites.push_back(sprite_for(std::string_view{sprite.name, strnlen(sprite.name, sizeof(sprite.name))}));
+    }
+
+    registry.storage<RenderComponent>().reserve(snapshot.renders().size());
+
+    for (const SnapshotRender& render: snapshot.renders()) {
+        registry.emplace<RenderComponent>(EntityHandle::from_raw(render.entity), render.sprite != SNAPSHOT_NULL_SPRITE ? sprites[render.sprite] : NULL_SPRITE,
+                                          render.offset_x, render.offset_y, render.face_up != 0);
+    }
+
+    registry.storage<DraggableComponent>().reserve(snapshot.draggables().size());
+
+    for (const SnapshotDraggable& draggable: snapshot.draggables()) {
+        registry.emplace<DraggableComponent>(EntityHandle::from_raw(draggable.entity)).is_selected = draggable.is_selected != 0;
+    }
+
+    registry.storage<StackableComponent>().reserve(snapshot.stackables().size());
+
+    for (std::uint32_t stackable: snapshot.stackables()) {
+        registry.emplace<StackableComponent>(EntityHandle::from_raw(stackable));
+    }
+
+    registry.storage<StackComponent>().reserve(snapshot.stacks().size());
+
+    for (const SnapshotStack& stack: snapshot.stacks()) {
+        std::vector<EntityHandle>& members = registry.emplace<StackComponent>(EntityHandle::from_raw(stack.entity)).members;
+        members.reserve(stack.members_count);
+
+        for (std::uint32_t member: snapshot.members().subspan(stack.members_begin, stack.members_count)) {
+            members.push_back(EntityHandle::from_raw(member));
+        }
+    }
+
+    std::vector<RenderList::Entry> draw_order;
+    draw_order.reserve(snapshot.draw_order().size());
+
+    for (std::uint32_t raw: snapshot.draw_order()) {
+        EntityHandle entity = EntityHandle::from_raw(raw);
+        RenderList::Key key{is_selected(entity) ? RenderLayer::Overlay : RenderLayer::Table, registry.get<TransformComponent>(entity).stack_index};
+        draw_order.push_back(RenderList::Entry{key, entity});
+    }
+
+    // Only a damaged file is out of order, its stack indices no longer match the saved draw order.
+    auto key_less = [](const RenderList::Entry& a, const RenderList::Entry& b) {
+        return a.key < b.key;
+    };
+
+    if (!std::is_sorted(draw_order.begin(), draw_order.end(), key_less)) {
+        std::stable_sort(draw_order.begin(), draw_order.end(), key_less);
+    }
+
+    render_list.assign(std::move(draw_order));
+
+    if (is_same_grid) {
+        std::vector<EntityHandle> cell;
+        std::size_t next = 0;
+
+        for (std::size_t index = 0; index < grid_cells.size() && grid_cells[index] <= grid_entities.size() - next; ++index) {
+            cell.clear();
+
+            for (std::uint32_t raw: grid_entities.subspan(next, grid_cells[index])) {
+                cell.push_back(EntityHandle::from_raw(raw));
+            }
+
+            spatial_grid.restore_cell_order(index, cell);
+            next += grid_cells[index];
+        }
+    }
+
+    std::istringstream rng_state{std::string{snapshot.rng_state()}};
+    rng_state >> rng;
+    seed = snapshot.header().seed;
+    tick = snapshot.header().tick;
+    left_clicked = snapshot.header().left_clicked != 0;
+
+    return true;
+}
+
+void Table::clear() {
+    commands.clear();
+    grid_updates.clear();
+    drops.clear();
+    history.clear();
+    spatial_grid.clear();
+    render_list.clear();
+    registry.clear();
+    left_clicked = false;
+    tick = 0;
+}
+
+static std::string deck_card_name(DeckType deck, std::size_t index) {
+    constexpr const char* RANKS[] = {"2", "3", "4", "5", "6", "7", "8", "9", "10", "jack", "queen", "king", "ace"};
+    constexpr const char* SUITS[] = {"clubs", "diamonds", "hearts", "spades"};
+    constexpr const std::size_t RANK_COUNT = std::size(RANKS);
+
+    std::size_t suit = deck == DeckType::Standard ? index / RANK_COUNT : (std::size_t) deck;
+
+    return std::string{RANKS[index % RANK_COUNT]} + "_of_" + SUITS[suit];
+}
+
+static std::size_t deck_size(DeckType deck) {
+    return deck == DeckType::Standard ? 52 : 13;
+}
+
+void generate_cards(Table& table, const GenerationData& generation_data, const std::function<SpriteHandle(std::string_view)>& sprite_for) {
+    std::vector<SpriteHandle> deck(deck_size(generation_data.deck));
+
+    for (std::size_t i = 0; i < deck.size(); ++i) {
+        deck[i] = sprite_for(deck_card_name(generation_data.deck, i));
+    }
+
+    table.spawn_layout(generation_data.layout, generation_data.start_position, deck);
+}
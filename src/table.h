@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <uuid.h>
+#include "command_buffer.h"
+#include "drop_event.h"
+#include "input.h"
+#include "layout.h"
+#include "move_history.h"
+#include "registry.h"
+#include "render_list.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include "spatial_grid.h"
+#include "sprite_handle.h"
+
+
+constexpr const float CARD_WIDTH = 83.25F;
+constexpr const float CARD_HEIGHT = 120.0F;
+constexpr const float CARD_SPACING = 4.0F;
+constexpr const char* CARD_BACK_SPRITE = "card_back"; // Drawn in place of a card's face while it is face down.
+
+// TODO: Add a way to limit where in a stack of card can a card be dropped. For example certain deck only allows cards to be dropped on the front
+// TODO: Just position still be window space or should it be a normalized world space? Figure out sizing, coordinate space, positioning
+
+// The whole simulation: entities, stacks and the drag and drop systems. Knows nothing about windows, input devices
+// or textures, so it runs the same under the raylib front end, headless and in benchmarks.
+class Table {
+public:
+    explicit Table(Rectangle bounds);
+
+    // Systems hold on to `this`.
+    Table(const Table&) = delete;
+
+    Table& operator=(const Table&) = delete;
+
+    EntityHandle create_card(Vector2 position, SpriteHandle sprite, bool is_stackable);
+
+    EntityHandle create_slot(Vector2 position, float offset_x, float offset_y);
+
+    // Creates every pile of `layout` with its top left at `origin` and deals `deck` onto them in order, in one pass
+    // with the stacks linked as they are created. Face down cards keep their face sprite with `face_up` cleared.
+    void spawn_layout(const LayoutPlan& layout, Vector2 origin, std::span<const SpriteHandle> deck);
+
+    void stack_to_entity(EntityHandle entity_to_stack, EntityHandle other_entity);
+
+    // Takes the entity off its stack, it stays where it is drawn now.
+    void detach(EntityHandle entity);
+
+    // Moves the entity and everything stacked above it.
+    void move(EntityHandle entity, Vector2 position);
+
+    void destroy(EntityHandle entity);
+
+    // Top-most draggable under `point`, or NULL_ENTITY. What the Drag System picks up.
+    EntityHandle pick(Vector2 point);
+
+    // Stackable the entity lands on if it is dropped where it is drawn now, or NULL_ENTITY. What the Drop System uses.
+    EntityHandle drop_target(EntityHandle entity);
+
+    // One fixed length tick: handles the Event and runs every system once, by priority. Structural changes they
+    // record are applied at the sync point at the end.
+    void step(const InputFrame& input);
+
+    // Drops of the last step, undone and redone ones included, in the order they happened.
+    [[nodiscard]] const std::vector<DropEvent>& get_drops() const {
+        return drops;
+    }
+
+    // Does what the Drop System did for `drop` right away, for replaying drops onto a restored table.
+    void apply_drop(const DropEvent& drop);
+
+    // Takes `drop` back. Only valid while the table is as `drop` left it, which undoing newest first guarantees.
+    void revert_drop(const DropEvent& drop);
+
+    [[nodiscard]] const MoveHistory& get_history() const {
+        return history;
+    }
+
+    MoveHistory& get_history() {
+        return history;
+    }
+
+    [[nodiscard]] const Scheduler& get_systems() const {
+        return systems;
+    }
+
+    // Recorded commands are applied at the end of the next step.
+    CommandBuffer& get_commands() {
+        return commands;
+    }
+
+    void clear();
+
+    [[nodiscard]] bool is_selected(EntityHandle entity);
+
+    [[nodiscard]] Rectangle get_screen_rec(EntityHandle entity) {
+        return registry.get<TransformComponent>(entity).screen_rec;
+    }
+
+    // Where to draw the entity `alpha` of the way from the previous tick to the last one.
+    [[nodiscard]] Rectangle get_interpolated_rec(EntityHandle entity, float alpha);
+
+    // Steps run so far.
+    [[nodiscard]] std::uint64_t get_tick() const {
+        return tick;
+    }
+
+    // Restarts the random sequence entity ids are drawn from. Seed before creating entities to reproduce a session.
+    void reseed(std::uint32_t seed_);
+
+    [[nodiscard]] std::uint32_t get_seed() const {
+        return seed;
+    }
+
+    // Suspends the whole table, tick and id sequence included. `sprite_name` names the sprites renders use, so they
+    // survive a sprite table that numbers them differently.
+    bool write_snapshot(const char* file_name, const std::function<std::string_view(SpriteHandle)>& sprite_name) const;
+
+    // Same as write_snapshot but into memory, for writing the file elsewhere.
+    bool encode_snapshot(const std::function<std::string_view(SpriteHandle)>& sprite_name, std::vector<unsigned char>& file_data) const;
+
+    // Only copies the table into the sections of a snapshot, encode_snapshot_file lays them out later and on any
+    // thread. Capturing into the same `snapshot_data` again reuses its storage.
+    bool capture_snapshot(const std::function<std::string_view(SpriteHandle)>& sprite_name, SnapshotData& snapshot_data) const;
+
+    // Replaces the table with a snapshot's. `sprite_for` maps the saved sprite names back to handles. The sections are
+    // copied into the pools, the registry's id lookup is only rebuilt once something looks an entity up by id.
+    bool load_snapshot(const Snapshot& snapshot, const std::function<SpriteHandle(std::string_view)>& sprite_for);
+
+    // Hash of everything the systems read and write. Two runs that hash the same after the same tick are in sync.
+    [[nodiscard]] std::uint64_t state_hash() const;
+
+    Registry& get_registry() {
+        return registry;
+    }
+
+    [[nodiscard]] const RenderList& get_render_list() const {
+        return render_list;
+    }
+
+private:
+    enum class PointerEvent : std::uint8_t {
+        None,
+        Pressed,
+        Released,
+    };
+
+    void drag_system();
+
+    // The drop about to be made, with what it takes to undo it.
+    DropEvent drop_event(EntityHandle entity, EntityHandle target);
+
+    void drop_system();
+
+    void update_system();
+
+    // Files what the systems before it moved into the spatial grid.
+    void grid_system();
+
+    bool is_top_entity(EntityHandle entity);
+
+    Rectangle resolve_screen_rec(EntityHandle entity);
+
+    // Only writes the entity's own transform, safe for different entities at the same time.
+    void store_screen_rec(EntityHandle entity, Rectangle rec);
+
+    void set_screen_rec(EntityHandle entity, Rectangle rec);
+
+    // For systems, which leave the spatial grid to the Spatial Grid system.
+    void queue_screen_rec(EntityHandle entity, Rectangle rec);
+
+    // Resolves and sets the screen recs and draw order of `entities`.
+    void resolve_screen_recs(std::span<const EntityHandle> entities);
+
+    void refresh_draw_order(EntityHandle entity);
+
+    void refresh_screen_recs(EntityHandle entity);
+
+    template<typename... Ts>
+    EntityHandle top_entity(Rectangle area, const std::function<bool(EntityHandle)>& predicate);
+
+    template<typename... Ts>
+    EntityHandle closest_entity(Rectangle rec, const std::function<bool(EntityHandle)>& predicate);
+
+    void move_to_entity(EntityHandle entity, EntityHandle other_entity);
+
+    Registry registry;
+    RenderList render_list;
+    SpatialGrid spatial_grid;
+    std::vector<EntityHandle> grid_updates; // Moved by systems this step, not in their new grid cells yet.
+    std::vector<std::uint8_t> moved_chunks; // Update System chunks of the draggable pool that moved something.
+    CommandBuffer commands;
+    std::vector<DropEvent> drops;
+    MoveHistory history;
+    Scheduler systems;
+    InputFrame input_frame;
+    std::uint64_t tick = 0;
+    PointerEvent pointer_event = PointerEvent::None;
+    std::uint32_t seed = std::mt19937::default_seed;
+    std::mt19937 rng{seed};
+    uuids::uuid_random_generator uuid_rng{rng};
+    bool left_clicked = false;
+};
+
+struct GenerationData {
+    Vector2 start_position;
+    DeckType deck;
+    LayoutPlan layout; // From compile_layout, or parse_layout for patterns that come in at runtime.
+};
+
+// `sprite_for` maps a card name like "2_of_clubs" to the sprite the front end draws it with.
+void generate_cards(Table& table, const GenerationData& generation_data, const std::function<SpriteHandle(std::string_view)>& sprite_for);
@@ -0,0 +1,56 @@
+#include "texture_cache.h"
+
+
+static std::size_t texture_bytes(const Texture2D& texture) {
+    return (std::size_t) GetPixelDataSize(texture.width, texture.height, texture.format);
+}
+
+TextureHandle TextureCache::insert(Texture2D texture) {
+    TextureHandle handle;
+
+    if (!free_handles.empty()) {
+        handle = free_handles.back();
+        free_handles.pop_back();
+        entries[handle] = Entry{texture, 1};
+    } else {
+        handle = (TextureHandle) entries.size();
+        entries.push_back(Entry{texture, 1});
+    }
+
+    ++resident;
+    bytes += texture_bytes(texture);
+
+    return handle;
+}
+
+void TextureCache::release(TextureHandle texture) {
+    if (texture == NULL_TEXTURE) {
+        return;
+    }
+
+    Entry& entry = entries[texture];
+
+    if (entry.ref_count == 0 || --entry.ref_count > 0) {
+        return;
+    }
+
+    --resident;
+    bytes -= texture_bytes(entry.texture);
+    UnloadTexture(entry.texture);
+
+    entry = Entry{};
+    free_handles.push_back(texture);
+}
+
+void TextureCache::clear() {
+    for (Entry& entry: entries) {
+        if (entry.ref_count > 0) {
+            UnloadTexture(entry.texture);
+        }
+    }
+
+    entries.clear();
+    free_handles.clear();
+    resident = 0;
+    bytes = 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <raylib.h>
+
+
+using TextureHandle = std::uint32_t;
+
+constexpr const TextureHandle NULL_TEXTURE = std::numeric_limits<TextureHandle>::max();
+
+// Reference counted GPU textures. Every card sprite points into the one atlas texture, which is unloaded once the last
+// user releases it.
+class TextureCache {
+public:
+    // Takes ownership of a texture generated at runtime, e.g. the atlas. Starts with one reference.
+    TextureHandle insert(Texture2D texture);
+
+    void retain(TextureHandle texture) {
+        ++entries[texture].ref_count;
+    }
+
+    void release(TextureHandle texture);
+
+    [[nodiscard]] const Texture2D& get(TextureHandle texture) const {
+        return entries[texture].texture;
+    }
+
+    [[nodiscard]] std::size_t resident_count() const {
+        return resident;
+    }
+
+    // Estimated GPU memory of every resident texture, mip levels not included.
+    [[nodiscard]] std::size_t resident_bytes() const {
+        return bytes;
+    }
+
+    // Unloads everything regardless of reference counts.
+    void clear();
+
+private:
+    struct Entry {
+        Texture2D texture;
+        std::uint32_t ref_count;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<TextureHandle> free_handles;
+    std::size_t resident = 0;
+    std::size_t bytes = 0;
+};